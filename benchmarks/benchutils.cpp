@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "benchutils.h"
+
+#include <QEventLoop>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QTextStream>
+
+#include "latencystats.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace Qt::StringLiterals;
+
+void BenchUtils::waitForFuture(const QFuture<void> &future)
+{
+    if (future.isFinished()) {
+        return;
+    }
+    QEventLoop loop;
+    QFutureWatcher<void> watcher;
+    QObject::connect(&watcher, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(future);
+    if (!future.isFinished()) {
+        loop.exec();
+    }
+}
+
+QJsonObject BenchUtils::toJson(const LatencyStats &stats)
+{
+    return {
+        {u"count"_s, static_cast<qint64>(stats.count())},
+        {u"mean"_s, stats.mean()},
+        {u"max"_s, stats.max()},
+        {u"p50"_s, stats.percentile(50)},
+        {u"p95"_s, stats.percentile(95)},
+        {u"p99"_s, stats.percentile(99)},
+    };
+}
+
+qint64 BenchUtils::peakRss()
+{
+#ifdef Q_OS_UNIX
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss;
+#else
+    // kilobytes on linux and the bsds
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+bool BenchUtils::writeJson(const QJsonObject &document, const QString &path)
+{
+    const QByteArray json = QJsonDocument(document).toJson(QJsonDocument::Indented);
+    if (path.isEmpty()) {
+        QTextStream(stdout) << json;
+        return true;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QTextStream(stderr) << "Could not write " << path << ": " << file.errorString() << "\n";
+        return false;
+    }
+    file.write(json);
+    return true;
+}
+
+QJsonObject BenchUtils::readJson(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QTextStream(stderr) << "Could not read " << path << ": " << file.errorString() << "\n";
+        return {};
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+static void compareMetrics(const QString &name,
+                           const QString &prefix,
+                           const QJsonObject &current,
+                           const QJsonObject &baseline,
+                           double threshold,
+                           double minimumMsecs,
+                           QJsonArray &regressions)
+{
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        const QJsonValue old = baseline.value(it.key());
+        const QString metric = prefix.isEmpty() ? it.key() : prefix + u'.' + it.key();
+        if (it->isObject() && old.isObject()) {
+            compareMetrics(name, metric, it->toObject(), old.toObject(), threshold, minimumMsecs, regressions);
+            continue;
+        }
+        // counts are not durations
+        if (!it->isDouble() || !old.isDouble() || it.key() == u"count" || it.key() == u"pages") {
+            continue;
+        }
+
+        const double now = it->toDouble();
+        const double before = old.toDouble();
+        if (now > before * (1.0 + threshold) && now - before > minimumMsecs) {
+            regressions.append(QJsonObject{
+                {u"name"_s, name},
+                {u"metric"_s, metric},
+                {u"baseline"_s, before},
+                {u"current"_s, now},
+            });
+        }
+    }
+}
+
+QJsonArray BenchUtils::findRegressions(const QJsonObject &current, const QJsonObject &baseline, double threshold, double minimumMsecs)
+{
+    QHash<QString, QJsonObject> baselineResults;
+    const QJsonArray oldResults = baseline.value(u"results"_s).toArray();
+    for (const QJsonValue &result : oldResults) {
+        baselineResults.insert(result[u"name"_s].toString(), result.toObject());
+    }
+
+    QJsonArray regressions;
+    const QJsonArray results = current.value(u"results"_s).toArray();
+    for (const QJsonValue &result : results) {
+        const QString name = result[u"name"_s].toString();
+        if (!baselineResults.contains(name)) {
+            continue;
+        }
+        compareMetrics(name, QString(), result.toObject(), baselineResults.value(name), threshold, minimumMsecs, regressions);
+    }
+    return regressions;
+}
@@ -0,0 +1,48 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef BENCHUTILS_H
+#define BENCHUTILS_H
+
+#include <QFuture>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+
+class LatencyStats;
+
+namespace BenchUtils
+{
+/**
+ * Runs the event loop until `future` is finished
+ */
+void waitForFuture(const QFuture<void> &future);
+
+/**
+ * mean, max, p50, p95 and p99 of `stats`
+ */
+QJsonObject toJson(const LatencyStats &stats);
+
+/**
+ * Highest resident memory of the process so far, in bytes, 0 where unknown
+ */
+qint64 peakRss();
+
+/**
+ * Writes `document` to `path`, or to stdout when `path` is empty
+ */
+bool writeJson(const QJsonObject &document, const QString &path);
+QJsonObject readJson(const QString &path);
+
+/**
+ * Compares the "results" of two reports, matched by their "name".
+ * All numbers are durations, lower is better; a metric regressed when it grew
+ * by more than `threshold` (0.1 is 10%) and by more than `minimumMsecs`.
+ */
+QJsonArray findRegressions(const QJsonObject &current, const QJsonObject &baseline, double threshold, double minimumMsecs = 0.5);
+}
+
+#endif // BENCHUTILS_H
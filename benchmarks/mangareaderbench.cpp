@@ -0,0 +1,210 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+
+#include "benchutils.h"
+#include "latencystats.h"
+#include "manga.h"
+
+using namespace Qt::StringLiterals;
+
+// a manga that takes longer than this to open is reported as failed
+static constexpr int IndexTimeout{10 * 60 * 1000};
+
+struct Options {
+    int width{1080};
+    int runs{3};
+    QString unrarPath;
+};
+
+static QString typeName(Manga::Type type)
+{
+    switch (type) {
+    case Manga::Type::FileCbz:
+        return u"cbz"_s;
+    case Manga::Type::FileCbr:
+        return u"cbr"_s;
+    case Manga::Type::FileCb7:
+        return u"cb7"_s;
+    case Manga::Type::FileCbt:
+        return u"cbt"_s;
+    case Manga::Type::Folder:
+        return u"folder"_s;
+    case Manga::Type::Unknown:
+        break;
+    }
+    return u"unknown"_s;
+}
+
+static void configure(Manga &manga, const Options &options)
+{
+    // every page has to be decoded, nothing may come from a cache
+    manga.setPageCacheSize(0);
+    manga.setCompressedPageCacheSize(0);
+    manga.setDiskCacheEnabled(false);
+    manga.setUnrarPath(options.unrarPath);
+}
+
+static QSize pageSize(const Image &image, int width)
+{
+    if (image.size.isEmpty()) {
+        return QSize(width, width * 3 / 2);
+    }
+    return QSize(width, qRound(static_cast<double>(image.size.height()) * width / image.size.width()));
+}
+
+/**
+ * Opens the manga and waits until its pages are listed, returns false on timeout
+ */
+static bool index(Manga &manga)
+{
+    bool indexed{false};
+    QEventLoop loop;
+    QObject::connect(&manga, &Manga::imagesReady, &loop, [&indexed, &loop]() {
+        indexed = true;
+        loop.quit();
+    });
+    QTimer::singleShot(IndexTimeout, &loop, &QEventLoop::quit);
+
+    // folders are listed synchronously
+    manga.init();
+    if (!indexed && manga.type() != Manga::Type::Unknown) {
+        loop.exec();
+    }
+    return indexed;
+}
+
+static double median(QList<double> values)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values.at(values.size() / 2);
+}
+
+static QJsonObject benchmark(const QString &path, const Options &options)
+{
+    QJsonObject result{
+        {u"name"_s, QFileInfo(path).fileName()},
+        {u"path"_s, path},
+    };
+
+    QList<double> indexTimes;
+    QList<double> firstPageTimes;
+    for (int run = 0; run < options.runs; ++run) {
+        Manga manga(path);
+        configure(manga, options);
+
+        QElapsedTimer timer;
+        timer.start();
+        if (!index(manga) || manga.images().isEmpty()) {
+            result.insert(u"type"_s, typeName(manga.type()));
+            result.insert(u"error"_s, u"could not list the pages"_s);
+            return result;
+        }
+        indexTimes.append(timer.nsecsElapsed() / 1e6);
+
+        QFuture<PageImage> firstPage = manga.requestPage(0, pageSize(manga.images().constFirst(), options.width));
+        BenchUtils::waitForFuture(QFuture<void>(firstPage));
+        firstPageTimes.append(timer.nsecsElapsed() / 1e6);
+    }
+
+    Manga manga(path);
+    configure(manga, options);
+    index(manga);
+    const QList<Image> images = manga.images();
+
+    // one page at a time, so each duration is the decode and scale of a single page
+    LatencyStats decodeTimes;
+    QElapsedTimer timer;
+    for (int i = 0; i < images.size(); ++i) {
+        timer.start();
+        QFuture<PageImage> page = manga.requestPage(i, pageSize(images.at(i), options.width));
+        BenchUtils::waitForFuture(QFuture<void>(page));
+        decodeTimes.add(timer.nsecsElapsed() / 1e6);
+    }
+
+    result.insert(u"type"_s, typeName(manga.type()));
+    result.insert(u"pages"_s, static_cast<qint64>(images.size()));
+    result.insert(u"timeToIndex"_s, median(indexTimes));
+    result.insert(u"timeToFirstPage"_s, median(firstPageTimes));
+    result.insert(u"decode"_s, BenchUtils::toJson(decodeTimes));
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(u"mangareader-bench"_s);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Measures how long mangas take to open, show their first page and decode each page."_s);
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"paths"_s, u"Folders and archives to benchmark"_s, u"paths..."_s);
+    QCommandLineOption widthOption(u"width"_s, u"Width pages are scaled to (default 1080)"_s, u"pixels"_s, u"1080"_s);
+    QCommandLineOption runsOption(u"runs"_s, u"Times each manga is opened, the median is reported (default 3)"_s, u"count"_s, u"3"_s);
+    QCommandLineOption outputOption({u"o"_s, u"output"_s}, u"Write the report to this file instead of stdout"_s, u"file"_s);
+    QCommandLineOption baselineOption(u"baseline"_s, u"Compare against an earlier report"_s, u"file"_s);
+    QCommandLineOption thresholdOption(u"threshold"_s, u"Slowdown reported as a regression (default 0.1, 10%)"_s, u"ratio"_s, u"0.1"_s);
+    QCommandLineOption unrarOption(u"unrar"_s, u"Path of the unrar executable, for cbr archives"_s, u"path"_s);
+    parser.addOptions({widthOption, runsOption, outputOption, baselineOption, thresholdOption, unrarOption});
+    parser.process(app);
+
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    Options options;
+    options.width = qMax(1, parser.value(widthOption).toInt());
+    options.runs = qMax(1, parser.value(runsOption).toInt());
+    options.unrarPath = parser.isSet(unrarOption) ? parser.value(unrarOption) : QStandardPaths::findExecutable(u"unrar"_s);
+
+    QJsonArray results;
+    for (const QString &path : paths) {
+        QTextStream(stderr) << "Benchmarking " << path << "\n";
+        results.append(benchmark(QFileInfo(path).absoluteFilePath(), options));
+    }
+
+    QJsonObject report{
+        {u"tool"_s, u"mangareader-bench"_s},
+        {u"version"_s, 1},
+        {u"width"_s, options.width},
+        {u"runs"_s, options.runs},
+        {u"results"_s, results},
+    };
+
+    int exitCode{0};
+    if (parser.isSet(baselineOption)) {
+        const QJsonArray regressions = BenchUtils::findRegressions(report,
+                                                                   BenchUtils::readJson(parser.value(baselineOption)),
+                                                                   parser.value(thresholdOption).toDouble());
+        report.insert(u"regressions"_s, regressions);
+        for (const QJsonValue &regression : regressions) {
+            QTextStream(stderr) << "Regression: " << regression[u"name"_s].toString() << " " << regression[u"metric"_s].toString() << " "
+                                << regression[u"baseline"_s].toDouble() << " ms -> " << regression[u"current"_s].toDouble() << " ms\n";
+        }
+        exitCode = regressions.isEmpty() ? 0 : 2;
+    }
+
+    if (!BenchUtils::writeJson(report, parser.value(outputOption))) {
+        return 1;
+    }
+    return exitCode;
+}
@@ -0,0 +1,314 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QImage>
+#include <QImageWriter>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimeZone>
+
+#include <KTar>
+#include <KZip>
+#ifdef WITH_K7ZIP
+#include <K7Zip>
+#endif
+
+using namespace Qt::StringLiterals;
+
+// archive entries get a fixed date so the same seed always gives the same bytes
+static const QDateTime EntryTime{QDate(2026, 1, 1), QTime(0, 0), QTimeZone::UTC};
+
+struct Options {
+    int pages{40};
+    QSize size{1600, 2400};
+    QStringList formats{u"jpg"_s};
+    bool webtoon{false};
+    quint32 seed{1};
+    int quality{85};
+};
+
+struct Page {
+    QString name;
+    QByteArray data;
+};
+
+static void drawPanel(QPainter &painter, const QRect &panel, QRandomGenerator &random, bool color)
+{
+    auto randomColor = [&random, color]() {
+        if (color) {
+            return QColor::fromHsv(random.bounded(360), 40 + random.bounded(160), 80 + random.bounded(170));
+        }
+        const int gray = random.bounded(256);
+        return QColor(gray, gray, gray);
+    };
+
+    QLinearGradient gradient(panel.topLeft(), panel.bottomRight());
+    gradient.setColorAt(0, randomColor());
+    gradient.setColorAt(1, randomColor());
+    painter.fillRect(panel, gradient);
+
+    // screentone, the dot pattern that makes real pages hard to compress
+    const int step = 4 + random.bounded(6);
+    const QRect tone = panel.adjusted(random.bounded(qMax(1, panel.width() / 2)), random.bounded(qMax(1, panel.height() / 2)), 0, 0);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(randomColor());
+    for (int y = tone.top(); y < tone.bottom(); y += step) {
+        for (int x = tone.left() + (y / step % 2) * step / 2; x < tone.right(); x += step) {
+            painter.drawEllipse(QPoint(x, y), step / 4, step / 4);
+        }
+    }
+
+    // line art
+    painter.setBrush(Qt::NoBrush);
+    const int strokes = 20 + random.bounded(60);
+    for (int i = 0; i < strokes; ++i) {
+        painter.setPen(QPen(color ? randomColor() : Qt::black, 1 + random.bounded(4)));
+        const QPoint from(panel.left() + random.bounded(qMax(1, panel.width())), panel.top() + random.bounded(qMax(1, panel.height())));
+        const QPoint to(panel.left() + random.bounded(qMax(1, panel.width())), panel.top() + random.bounded(qMax(1, panel.height())));
+        if (random.bounded(3) == 0) {
+            painter.drawEllipse(QRect(from, to).normalized());
+        } else {
+            painter.drawLine(from, to);
+        }
+    }
+
+    painter.setPen(QPen(Qt::black, 4));
+    painter.drawRect(panel);
+}
+
+static QImage generatePage(int number, const Options &options)
+{
+    QRandomGenerator random(options.seed * 7919u + static_cast<quint32>(number));
+
+    QSize size = options.size;
+    if (options.webtoon) {
+        // long strips of different heights
+        size.setHeight(options.size.height() + random.bounded(options.size.height()));
+    }
+
+    // most manga pages are black and white, some are in color
+    const bool color = options.webtoon || number % 8 == 0;
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const int margin = size.width() / 20;
+    const QRect area = image.rect().adjusted(margin, margin, -margin, -margin);
+    const int panelHeight = options.webtoon ? area.width() : area.height() / (2 + random.bounded(3));
+    for (int y = area.top(); y + margin < area.bottom(); y += panelHeight + margin) {
+        const QRect row(area.left(), y, area.width(), qMin(panelHeight, area.bottom() - y));
+        if (!options.webtoon && random.bounded(2) == 0) {
+            const int split = row.width() * (30 + random.bounded(40)) / 100;
+            drawPanel(painter, row.adjusted(0, 0, split - row.width() - margin / 2, 0), random, color);
+            drawPanel(painter, row.adjusted(split + margin / 2, 0, 0, 0), random, color);
+        } else {
+            drawPanel(painter, row, random, color);
+        }
+    }
+    painter.end();
+    return image;
+}
+
+static QList<Page> generatePages(const Options &options)
+{
+    QList<Page> pages;
+    const int digits = QString::number(options.pages).size();
+    for (int i = 0; i < options.pages; ++i) {
+        // the format mix repeats over the pages
+        const QString format = options.formats.at(i % options.formats.size());
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QImageWriter writer(&buffer, format.toLatin1());
+        writer.setQuality(options.quality);
+        if (!writer.write(generatePage(i, options))) {
+            QTextStream(stderr) << "Could not write page " << i << " as " << format << ": " << writer.errorString() << "\n";
+            continue;
+        }
+        pages.append({u"%1.%2"_s.arg(i + 1, digits, 10, u'0').arg(format), buffer.data()});
+    }
+    return pages;
+}
+
+static bool writeFolder(const QString &path, const QList<Page> &pages)
+{
+    if (!QDir().mkpath(path)) {
+        return false;
+    }
+    for (const Page &page : pages) {
+        QFile file(QDir(path).filePath(page.name));
+        if (!file.open(QIODevice::WriteOnly) || file.write(page.data) != page.data.size()) {
+            return false;
+        }
+        // 7z and rar store the times of the files they pack, flushed first so closing doesn't touch it again
+        if (!file.flush() || !file.setFileTime(EntryTime, QFileDevice::FileModificationTime)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool writeArchive(KArchive &archive, const QList<Page> &pages)
+{
+    if (!archive.open(QIODevice::WriteOnly)) {
+        QTextStream(stderr) << "Could not create " << archive.fileName() << ": " << archive.errorString() << "\n";
+        return false;
+    }
+    for (const Page &page : pages) {
+        if (!archive.writeFile(page.name, page.data, 0100644, u"user"_s, u"group"_s, EntryTime, EntryTime, EntryTime)) {
+            return false;
+        }
+    }
+    return archive.close();
+}
+
+/**
+ * Archives KArchive can't write, or can't write in the wanted flavour, are made with external tools
+ */
+static bool runTool(const QString &program, const QStringList &arguments, const QString &workingDirectory)
+{
+    const QString executable = QStandardPaths::findExecutable(program);
+    if (executable.isEmpty()) {
+        QTextStream(stderr) << program << " not found, skipping\n";
+        return false;
+    }
+    QProcess process;
+    process.setWorkingDirectory(workingDirectory);
+    process.start(executable, arguments);
+    if (!process.waitForFinished(-1) || process.exitCode() != 0) {
+        QTextStream(stderr) << program << " failed: " << process.readAllStandardError() << "\n";
+        return false;
+    }
+    return true;
+}
+
+static bool writeType(const QString &type, const QString &baseName, const QDir &output, const QList<Page> &pages)
+{
+    QStringList names;
+    for (const Page &page : pages) {
+        names.append(page.name);
+    }
+
+    if (type == u"folder") {
+        return writeFolder(output.filePath(baseName), pages);
+    }
+    if (type == u"cbz-stored" || type == u"cbz-deflated") {
+        KZip zip(output.filePath(baseName + u".cbz"_s));
+        zip.setCompression(type == u"cbz-stored" ? KZip::NoCompression : KZip::DeflateCompression);
+        return writeArchive(zip, pages);
+    }
+    if (type == u"cbt") {
+        KTar tar(output.filePath(baseName + u".cbt"_s), u"application/x-tar"_s);
+        return writeArchive(tar, pages);
+    }
+#ifdef WITH_K7ZIP
+    if (type == u"cb7") {
+        // K7Zip writes all files in one solid block
+        K7Zip sevenZip(output.filePath(baseName + u".cb7"_s));
+        return writeArchive(sevenZip, pages);
+    }
+#endif
+
+    // the external tools pack the pages from a folder
+    QTemporaryDir pagesFolder;
+    if (!pagesFolder.isValid() || !writeFolder(pagesFolder.path(), pages)) {
+        return false;
+    }
+    if (type == u"cb7-nonsolid") {
+        return runTool(u"7z"_s, QStringList{u"a"_s, u"-ms=off"_s, u"-bd"_s, output.absoluteFilePath(baseName + u".cb7"_s)} + names, pagesFolder.path());
+    }
+    if (type == u"cbr") {
+        return runTool(u"rar"_s, QStringList{u"a"_s, u"-idq"_s, u"-tl"_s, output.absoluteFilePath(baseName + u".cbr"_s)} + names, pagesFolder.path());
+    }
+
+    QTextStream(stderr) << "Unsupported type " << type << "\n";
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(u"mangareader-corpus"_s);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Writes synthetic mangas, the same seed always gives the same files."_s);
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"output"_s, u"Folder the mangas are written to"_s);
+    QCommandLineOption pagesOption(u"pages"_s, u"Pages per manga (default 40)"_s, u"count"_s, u"40"_s);
+    QCommandLineOption sizeOption(u"size"_s, u"Page size (default 1600x2400, 800x12000 for webtoons)"_s, u"WxH"_s);
+    QCommandLineOption formatsOption(u"formats"_s,
+                                     u"Comma separated image formats used in turn: jpg, png, webp, avif, jxl (default jpg)"_s,
+                                     u"list"_s,
+                                     u"jpg"_s);
+    QCommandLineOption typesOption(u"types"_s,
+                                   u"Comma separated: folder, cbz-stored, cbz-deflated, cb7, cb7-nonsolid, cbt, cbr (default all but cbr)"_s,
+                                   u"list"_s,
+                                   u"folder,cbz-stored,cbz-deflated,cb7,cb7-nonsolid,cbt"_s);
+    QCommandLineOption webtoonOption(u"webtoon"_s, u"Tall color strips instead of pages"_s);
+    QCommandLineOption seedOption(u"seed"_s, u"Seed of the page generator (default 1)"_s, u"number"_s, u"1"_s);
+    QCommandLineOption qualityOption(u"quality"_s, u"Quality of lossy formats (default 85)"_s, u"0-100"_s, u"85"_s);
+    parser.addOptions({pagesOption, sizeOption, formatsOption, typesOption, webtoonOption, seedOption, qualityOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    Options options;
+    options.pages = qMax(1, parser.value(pagesOption).toInt());
+    options.webtoon = parser.isSet(webtoonOption);
+    options.size = options.webtoon ? QSize(800, 12000) : QSize(1600, 2400);
+    if (parser.isSet(sizeOption)) {
+        const QStringList size = parser.value(sizeOption).split(u'x');
+        if (size.size() == 2 && size.at(0).toInt() > 0 && size.at(1).toInt() > 0) {
+            options.size = QSize(size.at(0).toInt(), size.at(1).toInt());
+        }
+    }
+    options.seed = parser.value(seedOption).toUInt();
+    options.quality = qBound(0, parser.value(qualityOption).toInt(), 100);
+
+    options.formats.clear();
+    const QList<QByteArray> supported = QImageWriter::supportedImageFormats();
+    const QStringList formats = parser.value(formatsOption).split(u',', Qt::SkipEmptyParts);
+    for (const QString &format : formats) {
+        if (!supported.contains(format.toLatin1())) {
+            QTextStream(stderr) << "No image writer for " << format << ", skipping\n";
+            continue;
+        }
+        options.formats.append(format);
+    }
+    if (options.formats.isEmpty()) {
+        return 1;
+    }
+
+    QDir output(parser.positionalArguments().constFirst());
+    if (!output.mkpath(u"."_s)) {
+        return 1;
+    }
+
+    const QList<Page> pages = generatePages(options);
+    const QString profile = options.webtoon ? u"webtoon"_s : u"standard"_s;
+    int failed{0};
+    const QStringList types = parser.value(typesOption).split(u',', Qt::SkipEmptyParts);
+    for (const QString &type : types) {
+        const QString baseName = u"%1-%2p-%3-%4"_s.arg(profile).arg(options.pages).arg(options.formats.join(u'-'), type);
+        QTextStream(stderr) << "Writing " << baseName << "\n";
+        if (!writeType(type, baseName, output, pages)) {
+            ++failed;
+        }
+    }
+    return failed == 0 ? 0 : 2;
+}
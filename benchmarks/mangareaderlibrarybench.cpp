@@ -0,0 +1,245 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <algorithm>
+
+#include "benchutils.h"
+#include "coverloader.h"
+#include "latencystats.h"
+#include "libraryindex.h"
+#include "librarymodel.h"
+#include "librarysearch.h"
+#include "mangatreewidget.h"
+
+using namespace Qt::StringLiterals;
+
+static qreal elapsedMsecs(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1'000'000.0;
+}
+
+/**
+ * Words of random entry names, what a user looking for a manga would type
+ */
+static QStringList pickQueries(const LibrarySearch &search, int count, quint32 seed)
+{
+    QStringList queries;
+    QRandomGenerator random(seed);
+    for (int i = 0; i < count * 10 && queries.size() < count && !search.isEmpty(); ++i) {
+        const QString name = QFileInfo(search.path(random.bounded(static_cast<int>(search.size())))).completeBaseName();
+        const QStringList words = name.split(QRegularExpression(u"[\\s_.\\-\\[\\]()]+"_s), Qt::SkipEmptyParts);
+        if (!words.isEmpty()) {
+            queries.append(words.at(random.bounded(static_cast<int>(words.size()))));
+        }
+    }
+    return queries;
+}
+
+/**
+ * The first `count` archives of the library, in the order of the index
+ */
+static QStringList pickArchives(const LibraryIndex &index, int count)
+{
+    QStringList archives;
+    QStringList directories = index.directories();
+    std::sort(directories.begin(), directories.end());
+    for (const QString &directoryPath : std::as_const(directories)) {
+        for (const LibraryIndex::Entry &entry : index.directory(directoryPath)->entries) {
+            if (archives.size() >= count) {
+                return archives;
+            }
+            if (!entry.isDir) {
+                archives.append(index.absolutePath(LibraryIndex::childPath(directoryPath, entry.name)));
+            }
+        }
+    }
+    return archives;
+}
+
+int main(int argc, char *argv[])
+{
+    // the library model loads icons, no window is shown
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    // the saved index goes to a test cache folder
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Measures scanning a manga library and searching it while typing."_s);
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"library"_s, u"Manga library folder"_s);
+    QCommandLineOption queriesOption(u"queries"_s, u"Comma separated queries, by default words of random entry names"_s, u"queries"_s);
+    QCommandLineOption contentsOption(u"contents"_s, u"Also read the file names and titles inside the archives"_s);
+    QCommandLineOption seedOption(u"seed"_s, u"Seed of the random queries (default 1)"_s, u"seed"_s, u"1"_s);
+    QCommandLineOption coversOption(u"covers"_s, u"Also make the covers of this many archives, then read them from the thumbnail cache"_s, u"count"_s);
+    QCommandLineOption outputOption({u"o"_s, u"output"_s}, u"Write the report to this file instead of stdout"_s, u"file"_s);
+    QCommandLineOption baselineOption(u"baseline"_s, u"Compare against an earlier report"_s, u"file"_s);
+    QCommandLineOption thresholdOption(u"threshold"_s, u"Slowdown reported as a regression (default 0.1, 10%)"_s, u"ratio"_s, u"0.1"_s);
+    parser.addOptions({queriesOption, contentsOption, seedOption, coversOption, outputOption, baselineOption, thresholdOption});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+    const QString library = QFileInfo(parser.positionalArguments().constFirst()).absoluteFilePath();
+
+    QElapsedTimer timer;
+    timer.start();
+    const LibraryIndex index = LibraryIndex::scan(library, LibraryIndex{});
+    const qreal scan = elapsedMsecs(timer);
+
+    // nothing changed, every folder is taken from the previous index
+    timer.start();
+    LibraryIndex::scan(library, index);
+    const qreal rescan = elapsedMsecs(timer);
+
+    QTemporaryDir cacheFolder;
+    const QString indexFile = cacheFolder.filePath(u"library.index"_s);
+    timer.start();
+    index.save(indexFile);
+    const qreal save = elapsedMsecs(timer);
+    timer.start();
+    LibraryIndex::load(indexFile);
+    const qreal load = elapsedMsecs(timer);
+
+    LibrarySearch::ContentsMap contents;
+    qreal readContents{0};
+    if (parser.isSet(contentsOption)) {
+        timer.start();
+        contents = LibrarySearch::readArchiveContents(index, {});
+        readContents = elapsedMsecs(timer);
+    }
+
+    timer.start();
+    const LibrarySearch search = LibrarySearch::build(index, contents);
+    const qreal build = elapsedMsecs(timer);
+
+    const QStringList queries = parser.isSet(queriesOption) ? parser.value(queriesOption).split(u',', Qt::SkipEmptyParts)
+                                                            : pickQueries(search, 20, parser.value(seedOption).toUInt());
+
+    // the tree's models, filtered the way the search field does it
+    LibraryModel model;
+    QEventLoop loop;
+    QObject::connect(&model, &LibraryModel::scanFinished, &loop, &QEventLoop::quit);
+    model.setRootPath(library);
+    if (model.isScanning()) {
+        loop.exec();
+    }
+    LibraryProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setRecursiveFilteringEnabled(true);
+    proxy.setAutoAcceptChildRows(true);
+    proxy.rowCount();
+
+    // typed one character at a time, like the tree's search field does it,
+    // with and without filtering the tree, which is what the user waits for
+    LatencyStats keystroke;
+    LatencyStats filteredKeystroke;
+    LatencyStats fullQuery;
+    qint64 matches{0};
+    for (const QString &query : queries) {
+        QList<qint32> results;
+        for (qsizetype length = 1; length <= query.size(); ++length) {
+            timer.start();
+            results = length == 1 ? search.search(query.left(length)) : search.refine(query.left(length), results);
+            keystroke.add(elapsedMsecs(timer));
+
+            QSet<QString> paths;
+            paths.reserve(results.size());
+            for (qint32 id : std::as_const(results)) {
+                paths.insert(search.path(id));
+            }
+            proxy.setMatches(paths);
+            proxy.rowCount();
+            filteredKeystroke.add(elapsedMsecs(timer));
+        }
+        timer.start();
+        matches += search.search(query).size();
+        fullQuery.add(elapsedMsecs(timer));
+    }
+
+    // the thumbnail cache is in the test cache folder, emptied so the covers are made
+    LatencyStats makeCover;
+    LatencyStats cachedCover;
+    if (parser.isSet(coversOption)) {
+        QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + u"/thumbnails"_s).removeRecursively();
+        const QStringList archives = pickArchives(index, parser.value(coversOption).toInt());
+        const QString unrarPath = QStandardPaths::findExecutable(u"unrar"_s);
+        for (LatencyStats *stats : {&makeCover, &cachedCover}) {
+            for (const QString &archive : archives) {
+                timer.start();
+                CoverLoader::load(archive, unrarPath);
+                stats->add(elapsedMsecs(timer));
+            }
+        }
+    }
+
+    QJsonObject result{
+        {u"name"_s, QFileInfo(library).fileName()},
+        {u"scan"_s, scan},
+        {u"rescan"_s, rescan},
+        {u"saveIndex"_s, save},
+        {u"loadIndex"_s, load},
+        {u"buildSearch"_s, build},
+        {u"keystroke"_s, BenchUtils::toJson(keystroke)},
+        {u"filteredKeystroke"_s, BenchUtils::toJson(filteredKeystroke)},
+        {u"search"_s, BenchUtils::toJson(fullQuery)},
+    };
+    if (parser.isSet(contentsOption)) {
+        result.insert(u"readArchiveContents"_s, readContents);
+    }
+    if (parser.isSet(coversOption)) {
+        result.insert(u"makeCover"_s, BenchUtils::toJson(makeCover));
+        result.insert(u"cachedCover"_s, BenchUtils::toJson(cachedCover));
+    }
+
+    QJsonObject report{
+        {u"tool"_s, u"mangareader-library-bench"_s},
+        {u"version"_s, 1},
+        {u"library"_s, library},
+        {u"directories"_s, static_cast<qint64>(index.directoryCount())},
+        {u"archives"_s, static_cast<qint64>(index.archiveCount())},
+        {u"entries"_s, static_cast<qint64>(search.size())},
+        {u"queries"_s, QJsonArray::fromStringList(queries)},
+        {u"matches"_s, matches},
+        {u"results"_s, QJsonArray{result}},
+    };
+
+    int exitCode{0};
+    if (parser.isSet(baselineOption)) {
+        const QJsonArray regressions = BenchUtils::findRegressions(report,
+                                                                   BenchUtils::readJson(parser.value(baselineOption)),
+                                                                   parser.value(thresholdOption).toDouble());
+        report.insert(u"regressions"_s, regressions);
+        for (const QJsonValue &regression : regressions) {
+            QTextStream(stderr) << "Regression: " << regression[u"name"_s].toString() << " " << regression[u"metric"_s].toString() << " "
+                                << regression[u"baseline"_s].toDouble() << " -> " << regression[u"current"_s].toDouble() << "\n";
+        }
+        exitCode = regressions.isEmpty() ? 0 : 2;
+    }
+
+    if (!BenchUtils::writeJson(report, parser.value(outputOption))) {
+        return 1;
+    }
+    return exitCode;
+}
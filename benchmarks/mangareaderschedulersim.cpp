@@ -0,0 +1,325 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QtMath>
+
+#include "benchutils.h"
+#include "latencystats.h"
+#include "prefetchwindow.h"
+#include "requestscheduler.h"
+
+using namespace Qt::StringLiterals;
+
+// pages are this many pixels high for the prefetch window, only ratios matter
+static constexpr qreal PageHeight{1000};
+// the view asks for pages on every frame
+static constexpr qint64 FrameInterval{16};
+// time kept running after the last scroll sample, so the queue drains
+static constexpr qint64 SettleTime{2000};
+
+struct Options {
+    int pages{200};
+    // viewport height, in pages
+    qreal viewport{0.7};
+    // furthest the prefetch band reaches on one side, in viewports
+    qreal maxExtent{6};
+    qreal decodeCost{40};
+    qreal jitter{0.5};
+    quint32 seed{1};
+    QList<qreal> costs;
+};
+
+struct Sample {
+    qint64 at;
+    qreal position;
+};
+
+struct ScrollTrace {
+    QString name;
+    QList<Sample> samples;
+};
+
+/**
+ * Position, in pages, of the top of the viewport at `at`, linear between samples
+ */
+static qreal positionAt(const QList<Sample> &samples, qint64 at)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    if (at <= samples.constFirst().at) {
+        return samples.constFirst().position;
+    }
+    for (qsizetype i = 1; i < samples.size(); ++i) {
+        const Sample &previous = samples.at(i - 1);
+        const Sample &next = samples.at(i);
+        if (at <= next.at) {
+            const qreal t = next.at == previous.at ? 1.0 : static_cast<qreal>(at - previous.at) / (next.at - previous.at);
+            return previous.position + (next.position - previous.position) * t;
+        }
+    }
+    return samples.constLast().position;
+}
+
+static QList<ScrollTrace> builtInTraces(int pageCount)
+{
+    QList<ScrollTrace> traces;
+    const qreal last = pageCount - 1;
+
+    // reads a viewport, then moves to the next one with a short smooth scroll
+    ScrollTrace reading{u"reading"_s, {}};
+    qint64 at{0};
+    for (qreal position = 0; position < qMin(last, 40.0); position += 0.7) {
+        reading.samples.append({at, position});
+        at += 3000;
+        reading.samples.append({at, position});
+        at += 150;
+    }
+    traces.append(reading);
+
+    // flicks of a few pages with short pauses
+    ScrollTrace skimming{u"skimming"_s, {}};
+    at = 0;
+    for (qreal position = 0; position < qMin(last, 120.0); position += 3) {
+        skimming.samples.append({at, position});
+        at += 200;
+        skimming.samples.append({at, position + 3});
+        at += 300;
+    }
+    traces.append(skimming);
+
+    // a long fling down, a stop, and a fling back up
+    ScrollTrace fling{u"fling"_s, {{0, 0}, {5000, qMin(last, 40.0)}, {7000, qMin(last, 40.0)}, {9000, qMin(last, 20.0)}}};
+    traces.append(fling);
+
+    // forward, back to check something, forward again
+    ScrollTrace backtrack{u"backtrack"_s, {}};
+    at = 0;
+    qreal position{0};
+    for (int i = 0; i < 10 && position + 4 < last; ++i) {
+        backtrack.samples.append({at, position});
+        at += 1500;
+        backtrack.samples.append({at, position + 4});
+        at += 1000;
+        backtrack.samples.append({at, position + 2});
+        at += 1000;
+        position += 2;
+    }
+    traces.append(backtrack);
+
+    return traces;
+}
+
+/**
+ * Reads {"samples": [{"at": 0, "position": 0.0}, ...]}, positions in pages
+ */
+static ScrollTrace readTrace(const QString &path)
+{
+    ScrollTrace trace{path, {}};
+    const QJsonArray samples = BenchUtils::readJson(path)[u"samples"_s].toArray();
+    for (const QJsonValue &sample : samples) {
+        trace.samples.append({sample[u"at"_s].toInteger(), sample[u"position"_s].toDouble()});
+    }
+    return trace;
+}
+
+static QList<qreal> decodeCosts(const Options &options)
+{
+    if (!options.costs.isEmpty()) {
+        QList<qreal> costs;
+        for (int page = 0; page < options.pages; ++page) {
+            costs.append(options.costs.at(page % options.costs.size()));
+        }
+        return costs;
+    }
+    // seeded so every policy and run sees the same pages
+    QRandomGenerator random(options.seed);
+    QList<qreal> costs;
+    for (int page = 0; page < options.pages; ++page) {
+        const qreal variation = (random.generateDouble() * 2 - 1) * options.jitter;
+        costs.append(qMax(1.0, options.decodeCost * (1 + variation)));
+    }
+    return costs;
+}
+
+/**
+ * Steps a virtual clock one millisecond at a time. Every frame the pages in the
+ * prefetch band that have no image are requested, like View::setPagesVisibility does,
+ * and pages leaving the band drop theirs. A single worker decodes one request at a time.
+ */
+static QJsonObject simulate(const ScrollTrace &trace, RequestScheduler::Policy policy, const Options &options, const QList<qreal> &costs)
+{
+    std::unique_ptr<RequestScheduler> scheduler = RequestScheduler::create(policy);
+    PrefetchWindow prefetchWindow;
+
+    QList<bool> hasImage(options.pages, false);
+    QHash<int, qint64> visibleSince;
+    LatencyStats visibleLatency;
+    qint64 blankTime{0};
+    qint64 decodes{0};
+    qint64 wastedDecodes{0};
+    qreal averageDecodeTime{0};
+
+    std::unique_ptr<ImageRequest> running;
+    qint64 runningUntil{0};
+    int firstBandPage{0};
+    int lastBandPage{-1};
+
+    const qint64 end = trace.samples.isEmpty() ? 0 : trace.samples.constLast().at + SettleTime;
+    const qreal viewportHeight = options.viewport * PageHeight;
+    const qreal maxExtent = options.maxExtent * viewportHeight;
+    for (qint64 now = 0; now <= end; ++now) {
+        const qreal position = qBound(0.0, positionAt(trace.samples, now), qMax(0.0, options.pages - options.viewport));
+        const int firstVisible = qFloor(position);
+        const int lastVisible = qMin(options.pages - 1, qCeil(position + options.viewport) - 1);
+
+        if (running && now >= runningUntil) {
+            const int page = running->pageNumber;
+            ++decodes;
+            averageDecodeTime += (costs.at(page) - averageDecodeTime) * 0.2;
+            // left the band while decoding, or decoded twice
+            if (page < firstBandPage || page > lastBandPage || hasImage.at(page)) {
+                ++wastedDecodes;
+            } else {
+                hasImage[page] = true;
+                if (auto it = visibleSince.find(page); it != visibleSince.end()) {
+                    visibleLatency.add(now - it.value());
+                    visibleSince.erase(it);
+                }
+            }
+            running.reset();
+        }
+
+        if (now % FrameInterval == 0) {
+            prefetchWindow.addScrollSample(now, position * PageHeight);
+            prefetchWindow.setDecodeTime(averageDecodeTime);
+            const PrefetchWindow::Band band = prefetchWindow.band(now, viewportHeight, PageHeight, 0, maxExtent);
+            firstBandPage = qMax(0, qFloor((position * PageHeight - band.before) / PageHeight));
+            lastBandPage = qMin(options.pages - 1, qCeil((position * PageHeight + viewportHeight + band.after) / PageHeight) - 1);
+
+            std::vector<std::unique_ptr<ImageRequest>> requests;
+            for (int page = 0; page < options.pages; ++page) {
+                if (page < firstBandPage || page > lastBandPage) {
+                    hasImage[page] = false;
+                    continue;
+                }
+                if (!hasImage.at(page)) {
+                    auto request = std::make_unique<ImageRequest>();
+                    request->pageNumber = page;
+                    requests.push_back(std::move(request));
+                }
+            }
+            scheduler->setScrollState({position + options.viewport / 2, prefetchWindow.velocity(now) * 1000.0 / PageHeight});
+            scheduler->addReplacing(std::move(requests));
+
+            for (auto it = visibleSince.begin(); it != visibleSince.end();) {
+                // scrolled away before it showed up
+                if (it.key() < firstVisible || it.key() > lastVisible) {
+                    it = visibleSince.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for (int page = firstVisible; page <= lastVisible; ++page) {
+                if (!hasImage.at(page) && !visibleSince.contains(page)) {
+                    visibleSince.insert(page, now);
+                }
+            }
+        }
+
+        if (!running) {
+            running = scheduler->takeNext();
+            if (running) {
+                runningUntil = now + qCeil(costs.at(running->pageNumber));
+            }
+        }
+
+        for (int page = firstVisible; page <= lastVisible; ++page) {
+            if (!hasImage.at(page)) {
+                ++blankTime;
+                break;
+            }
+        }
+    }
+
+    return {
+        {u"name"_s, trace.name + u'/' + RequestScheduler::policyName(policy)},
+        {u"visibleLatency"_s, BenchUtils::toJson(visibleLatency)},
+        {u"blankTime"_s, blankTime},
+        {u"decodes"_s, decodes},
+        {u"wastedDecodes"_s, wastedDecodes},
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(u"mangareader-scheduler-sim"_s);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Compares request scheduling policies on scroll traces, with a decode cost model instead of real decoding."_s);
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"traces"_s, u"JSON scroll traces, the built in ones when none are given"_s, u"[traces...]"_s);
+    QCommandLineOption pagesOption(u"pages"_s, u"Pages in the simulated manga (default 200)"_s, u"count"_s, u"200"_s);
+    QCommandLineOption viewportOption(u"viewport"_s, u"Viewport height in pages (default 0.7)"_s, u"pages"_s, u"0.7"_s);
+    QCommandLineOption costOption(u"decode-cost"_s, u"Mean time to decode a page (default 40)"_s, u"msecs"_s, u"40"_s);
+    QCommandLineOption jitterOption(u"jitter"_s, u"Decode time variation between pages (default 0.5, ±50%)"_s, u"ratio"_s, u"0.5"_s);
+    QCommandLineOption costsOption(u"costs"_s, u"JSON file with {\"costs\": [msecs, ...]}, per page decode times used in turn"_s, u"file"_s);
+    QCommandLineOption seedOption(u"seed"_s, u"Seed of the decode times (default 1)"_s, u"number"_s, u"1"_s);
+    QCommandLineOption outputOption({u"o"_s, u"output"_s}, u"Write the report to this file instead of stdout"_s, u"file"_s);
+    parser.addOptions({pagesOption, viewportOption, costOption, jitterOption, costsOption, seedOption, outputOption});
+    parser.process(app);
+
+    Options options;
+    options.pages = qMax(1, parser.value(pagesOption).toInt());
+    options.viewport = qMax(0.1, parser.value(viewportOption).toDouble());
+    options.decodeCost = qMax(1.0, parser.value(costOption).toDouble());
+    options.jitter = qBound(0.0, parser.value(jitterOption).toDouble(), 1.0);
+    options.seed = parser.value(seedOption).toUInt();
+    if (parser.isSet(costsOption)) {
+        const QJsonArray costs = BenchUtils::readJson(parser.value(costsOption))[u"costs"_s].toArray();
+        for (const QJsonValue &cost : costs) {
+            options.costs.append(qMax(1.0, cost.toDouble()));
+        }
+    }
+
+    QList<ScrollTrace> traces;
+    const QStringList paths = parser.positionalArguments();
+    for (const QString &path : paths) {
+        traces.append(readTrace(path));
+    }
+    if (traces.isEmpty()) {
+        traces = builtInTraces(options.pages);
+    }
+
+    const QList<qreal> costs = decodeCosts(options);
+    QJsonArray results;
+    for (const ScrollTrace &trace : std::as_const(traces)) {
+        for (auto policy : {RequestScheduler::Policy::Lifo, RequestScheduler::Policy::Distance, RequestScheduler::Policy::Velocity}) {
+            QJsonObject result = simulate(trace, policy, options, costs);
+            QTextStream(stderr) << result.value(u"name"_s).toString() << ": visible p95 "
+                                << result.value(u"visibleLatency"_s)[u"p95"_s].toDouble() << " ms, wasted decodes "
+                                << result.value(u"wastedDecodes"_s).toInteger() << "/" << result.value(u"decodes"_s).toInteger() << "\n";
+            results.append(result);
+        }
+    }
+
+    const QJsonObject report{
+        {u"tool"_s, u"mangareader-scheduler-sim"_s},
+        {u"version"_s, 1},
+        {u"pages"_s, options.pages},
+        {u"viewport"_s, options.viewport},
+        {u"results"_s, results},
+    };
+    return BenchUtils::writeJson(report, parser.value(outputOption)) ? 0 : 1;
+}
@@ -0,0 +1,323 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QGraphicsScene>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+#include <QWheelEvent>
+
+#include "benchutils.h"
+#include "latencystats.h"
+#include "mainwindow.h"
+#include "page.h"
+#include "settings.h"
+#include "view.h"
+
+using namespace Qt::StringLiterals;
+
+// a manga that takes longer than this to open is reported as failed
+static constexpr int OpenTimeout{10 * 60 * 1000};
+// the replay runs at 60 frames per second
+static constexpr int FrameInterval{16};
+// frames kept running after the last event, so pending decodes land
+static constexpr int SettleTime{1000};
+static constexpr int WheelStep{120};
+
+/**
+ * Events are JSON objects with the time they happen at, in milliseconds from the
+ * start of the replay, and a type, with the arguments of that type:
+ * {"at": 0, "type": "wheel", "delta": -120}
+ * {"at": 0, "type": "smoothScrolling", "enabled": true}
+ * {"at": 0, "type": "goToPage", "page": 10}
+ * {"at": 0, "type": "resize", "width": 1280, "height": 720}
+ * {"at": 0, "type": "zoom", "direction": "in"} (or "out", "reset")
+ */
+static QJsonArray defaultScript(int pageCount)
+{
+    QJsonArray events;
+    qint64 at{0};
+    auto add = [&events, &at](QJsonObject event) {
+        event.insert(u"at"_s, at);
+        events.append(event);
+    };
+    auto wheelBursts = [&add, &at](int bursts, int direction) {
+        for (int burst = 0; burst < bursts; ++burst) {
+            for (int i = 0; i < 10; ++i) {
+                add({{u"type"_s, u"wheel"_s}, {u"delta"_s, direction * WheelStep}});
+                at += FrameInterval;
+            }
+            at += 300;
+        }
+    };
+
+    add({{u"type"_s, u"smoothScrolling"_s}, {u"enabled"_s, false}});
+    wheelBursts(5, -1);
+    add({{u"type"_s, u"smoothScrolling"_s}, {u"enabled"_s, true}});
+    wheelBursts(5, -1);
+    wheelBursts(2, 1);
+
+    for (int page : {pageCount / 2, pageCount - 3, 2}) {
+        add({{u"type"_s, u"goToPage"_s}, {u"page"_s, qBound(0, page, pageCount - 1)}});
+        at += 500;
+    }
+
+    for (const QSize &size : {QSize(1280, 720), QSize(900, 1400), QSize(1920, 1080)}) {
+        add({{u"type"_s, u"resize"_s}, {u"width"_s, size.width()}, {u"height"_s, size.height()}});
+        at += 500;
+    }
+
+    for (const QString &direction : {u"in"_s, u"in"_s, u"out"_s, u"reset"_s}) {
+        add({{u"type"_s, u"zoom"_s}, {u"direction"_s, direction}});
+        at += 300;
+    }
+
+    // a few seconds of continuous reading
+    for (int i = 0; i < 180; ++i) {
+        add({{u"type"_s, u"wheel"_s}, {u"delta"_s, -WheelStep / 2}});
+        at += FrameInterval;
+    }
+    return events;
+}
+
+static void dispatch(const QJsonObject &event, MainWindow &window, View *view)
+{
+    const QString type = event[u"type"_s].toString();
+    if (type == u"wheel") {
+        const QPointF position = QRectF(view->viewport()->rect()).center();
+        QWheelEvent wheel(position,
+                          view->viewport()->mapToGlobal(position),
+                          QPoint(),
+                          QPoint(0, event[u"delta"_s].toInt()),
+                          Qt::NoButton,
+                          Qt::NoModifier,
+                          Qt::NoScrollPhase,
+                          false);
+        QCoreApplication::sendEvent(view->viewport(), &wheel);
+    } else if (type == u"smoothScrolling") {
+        MangaReaderSettings::setSmoothScrolling(event[u"enabled"_s].toBool());
+    } else if (type == u"goToPage") {
+        view->goToPage(event[u"page"_s].toInt());
+    } else if (type == u"resize") {
+        window.resize(event[u"width"_s].toInt(), event[u"height"_s].toInt());
+    } else if (type == u"zoom") {
+        const QString direction = event[u"direction"_s].toString();
+        if (direction == u"in") {
+            view->zoomIn();
+        } else if (direction == u"out") {
+            view->zoomOut();
+        } else {
+            view->zoomReset();
+        }
+    } else {
+        QTextStream(stderr) << "Unknown event " << type << "\n";
+    }
+}
+
+/**
+ * A page inside the viewport with nothing to show, not even a preview
+ */
+static bool isBlankPageVisible(View *view)
+{
+    const QList<QGraphicsItem *> items = view->items(view->viewport()->rect());
+    for (QGraphicsItem *item : items) {
+        Page *page = qgraphicsitem_cast<Page *>(item);
+        if (page && page->isImageDeleted() && !page->hasPreview()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Bytes held by the pages' images, pixmaps, previews and tiles
+ */
+static qint64 pageMemory(View *view)
+{
+    qint64 bytes{0};
+    const QList<QGraphicsItem *> items = view->scene()->items();
+    for (QGraphicsItem *item : items) {
+        if (const Page *page = qgraphicsitem_cast<Page *>(item)) {
+            bytes += page->memoryFootprint();
+        }
+    }
+    return bytes;
+}
+
+static bool open(MainWindow &window, View *view, const QString &path)
+{
+    bool opened{false};
+    QEventLoop loop;
+    auto connection = QObject::connect(view, &View::imagesLoaded, &loop, [&opened, &loop]() {
+        opened = true;
+        loop.quit();
+    });
+    QTimer::singleShot(OpenTimeout, &loop, &QEventLoop::quit);
+    window.loadImages(path);
+    if (!opened) {
+        loop.exec();
+    }
+    QObject::disconnect(connection);
+    return opened && view->imageCount() > 0;
+}
+
+static QJsonObject replay(MainWindow &window, const QString &path, const QJsonArray &script, bool leanPageMemory)
+{
+    QJsonObject result{
+        {u"name"_s, QFileInfo(path).fileName() + (leanPageMemory ? u" (lean page memory)"_s : QString())},
+        {u"path"_s, path},
+        {u"leanPageMemory"_s, leanPageMemory},
+    };
+    // pages apply it when they get their image, it's set before the manga is opened
+    MangaReaderSettings::setLeanPageMemory(leanPageMemory);
+
+    View *view = window.findChild<View *>();
+    window.resize(1280, 720);
+    view->verticalScrollBar()->setValue(0);
+    if (!open(window, view, path)) {
+        result.insert(u"error"_s, u"could not open"_s);
+        return result;
+    }
+
+    QJsonArray events = script.isEmpty() ? defaultScript(view->imageCount()) : script;
+    const qint64 end = events.isEmpty() ? 0 : events.last()[u"at"_s].toInteger() + SettleTime;
+
+    LatencyStats frameTimes;
+    qint64 blankTime{0};
+    qint64 blankFrames{0};
+    qsizetype next{0};
+    qint64 lastFrame{0};
+
+    QElapsedTimer clock;
+    QEventLoop loop;
+    QTimer ticker;
+    ticker.setTimerType(Qt::PreciseTimer);
+    ticker.setInterval(FrameInterval);
+    QObject::connect(&ticker, &QTimer::timeout, &loop, [&]() {
+        const qint64 now = clock.elapsed();
+        while (next < events.size() && events.at(next)[u"at"_s].toInteger() <= now) {
+            dispatch(events.at(next).toObject(), window, view);
+            ++next;
+        }
+        view->viewport()->repaint();
+
+        // gui thread work between two frames, decoded pages arriving included,
+        // shows up as frames longer than the interval
+        const qint64 frameEnd = clock.elapsed();
+        frameTimes.add(frameEnd - lastFrame);
+        if (isBlankPageVisible(view)) {
+            blankTime += frameEnd - lastFrame;
+            ++blankFrames;
+        }
+        lastFrame = frameEnd;
+
+        if (now >= end) {
+            loop.quit();
+        }
+    });
+    clock.start();
+    ticker.start();
+    loop.exec();
+
+    result.insert(u"pages"_s, view->imageCount());
+    result.insert(u"frameTime"_s, BenchUtils::toJson(frameTimes));
+    result.insert(u"blankPageVisibleTime"_s, blankTime);
+    result.insert(u"blankFrames"_s, blankFrames);
+    // taken once the replay settled, not on every frame so it doesn't add to the frame times
+    result.insert(u"pageMemoryMiB"_s, pageMemory(view) / (1024.0 * 1024.0));
+    // the peak of the whole process so far, mangas read earlier count too
+    result.insert(u"peakRssMiB"_s, BenchUtils::peakRss() / (1024.0 * 1024.0));
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // no window is shown, runs on machines without a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // settings changed by the replay don't touch the user's configuration
+    QStandardPaths::setTestModeEnabled(true);
+
+    QApplication app(argc, argv);
+    // the ui files are looked up under the app's name
+    QApplication::setApplicationName(u"mangareader"_s);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Replays scrolling through mangas in the reader and measures how smooth it is."_s);
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"paths"_s, u"Folders and archives to read"_s, u"paths..."_s);
+    QCommandLineOption scriptOption(u"script"_s, u"JSON file with the events to replay, instead of the built in ones"_s, u"file"_s);
+    QCommandLineOption outputOption({u"o"_s, u"output"_s}, u"Write the report to this file instead of stdout"_s, u"file"_s);
+    QCommandLineOption baselineOption(u"baseline"_s, u"Compare against an earlier report"_s, u"file"_s);
+    QCommandLineOption thresholdOption(u"threshold"_s, u"Slowdown reported as a regression (default 0.1, 10%)"_s, u"ratio"_s, u"0.1"_s);
+    QCommandLineOption leanOption(u"lean-page-memory"_s, u"Replay with lean page memory on, off or both (default off)"_s, u"mode"_s, u"off"_s);
+    parser.addOptions({scriptOption, outputOption, baselineOption, thresholdOption, leanOption});
+    parser.process(app);
+
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const QString leanMode = parser.value(leanOption);
+    QList<bool> leanModes;
+    if (leanMode == u"off" || leanMode == u"both") {
+        leanModes.append(false);
+    }
+    if (leanMode == u"on" || leanMode == u"both") {
+        leanModes.append(true);
+    }
+    if (leanModes.isEmpty()) {
+        QTextStream(stderr) << "Unknown lean page memory mode " << leanMode << "\n";
+        return 1;
+    }
+
+    const QJsonArray script = parser.isSet(scriptOption) ? BenchUtils::readJson(parser.value(scriptOption))[u"events"_s].toArray() : QJsonArray{};
+
+    MainWindow window;
+    window.show();
+
+    QJsonArray results;
+    for (const QString &path : paths) {
+        for (bool lean : std::as_const(leanModes)) {
+            QTextStream(stderr) << "Replaying " << path << (lean ? " with lean page memory" : "") << "\n";
+            results.append(replay(window, QFileInfo(path).absoluteFilePath(), script, lean));
+        }
+    }
+
+    QJsonObject report{
+        {u"tool"_s, u"mangareader-scroll-bench"_s},
+        {u"version"_s, 1},
+        {u"results"_s, results},
+    };
+
+    int exitCode{0};
+    if (parser.isSet(baselineOption)) {
+        const QJsonArray regressions = BenchUtils::findRegressions(report,
+                                                                   BenchUtils::readJson(parser.value(baselineOption)),
+                                                                   parser.value(thresholdOption).toDouble());
+        report.insert(u"regressions"_s, regressions);
+        for (const QJsonValue &regression : regressions) {
+            QTextStream(stderr) << "Regression: " << regression[u"name"_s].toString() << " " << regression[u"metric"_s].toString() << " "
+                                << regression[u"baseline"_s].toDouble() << " -> " << regression[u"current"_s].toDouble() << "\n";
+        }
+        exitCode = regressions.isEmpty() ? 0 : 2;
+    }
+
+    if (!BenchUtils::writeJson(report, parser.value(outputOption))) {
+        return 1;
+    }
+    return exitCode;
+}
@@ -0,0 +1,314 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+#include <QTreeView>
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include "benchutils.h"
+#include "latencystats.h"
+#include "mainwindow.h"
+#include "mangatreewidget.h"
+#include "page.h"
+#include "settings.h"
+#include "view.h"
+
+using namespace Qt::StringLiterals;
+
+// a startup milestone not reached in this time is reported as missing
+static constexpr int MilestoneTimeout{60 * 1000};
+// how often the gui thread is checked on
+static constexpr int ProbeInterval{10};
+// a check coming this much later than it was due means the gui thread was busy
+static constexpr int LongTask{50};
+// the reader is interactive once the gui thread wasn't busy for this long
+static constexpr int QuietWindow{500};
+
+/**
+ * Points the reader's configuration, in test mode so the user's own is untouched,
+ * at `library` and adds `bookmarkCount` bookmarks to mangas inside it
+ */
+static void setupConfig(const QString &library, int bookmarkCount)
+{
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(u"mangareader/mangareader.conf"_s);
+    config->group(QString()).writeEntry("Manga Folder", library);
+
+    KConfigGroup bookmarks = config->group(u"Bookmarks"_s);
+    bookmarks.deleteGroup();
+    if (!library.isEmpty() && bookmarkCount > 0) {
+        QDirIterator it(library, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        int count{0};
+        while (it.hasNext() && count < bookmarkCount) {
+            bookmarks.writeEntry(it.next(), QString::number(count % 20));
+            ++count;
+        }
+    }
+    config->sync();
+
+    MangaReaderSettings::setMangaFolders(library.isEmpty() ? QStringList{} : QStringList{library});
+    MangaReaderSettings::self()->save();
+}
+
+/**
+ * Milliseconds from the start of the MainWindow constructor to each milestone,
+ * -1 for the ones not reached.
+ *
+ * The milestones are taken from what any version of the reader does, not from
+ * signals of its own, so a report of an older version can be the baseline:
+ * - timeToWindow: the first paint of one of the window's widgets
+ * - timeToInteractive: the end of the last long gui thread task, once none
+ *   followed for QuietWindow
+ * - timeToLibrary: the library tree shows its first entries
+ * - timeToFirstPage: a page in the view has its image
+ */
+struct StartupTimes {
+    qint64 constructor{-1};
+    qint64 timeToWindow{-1};
+    qint64 timeToInteractive{-1};
+    qint64 timeToLibrary{-1};
+    qint64 timeToFirstPage{-1};
+};
+
+/**
+ * Notes when a widget of the window is painted the first time
+ */
+class FirstPaintFilter : public QObject
+{
+public:
+    FirstPaintFilter(const QWidget *window, const QElapsedTimer &clock, qint64 &painted)
+        : m_window{window}
+        , m_clock{clock}
+        , m_painted{painted}
+    {
+    }
+
+    bool eventFilter(QObject *object, QEvent *event) override
+    {
+        if (m_painted < 0 && event->type() == QEvent::Paint && object->isWidgetType()
+            && static_cast<QWidget *>(object)->window() == m_window) {
+            m_painted = m_clock.elapsed();
+        }
+        return false;
+    }
+
+private:
+    const QWidget *m_window;
+    const QElapsedTimer &m_clock;
+    qint64 &m_painted;
+};
+
+static bool isLibraryListed(const QTreeView *treeView)
+{
+    return treeView && treeView->model() && treeView->model()->rowCount(treeView->rootIndex()) > 0;
+}
+
+static bool isPageShown(View *view)
+{
+    const QList<QGraphicsItem *> items = view->items(view->viewport()->rect());
+    for (QGraphicsItem *item : items) {
+        // older versions' pages have no item type of their own
+        auto page = dynamic_cast<Page *>(item);
+        if (page && !page->isImageDeleted()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static StartupTimes start(const QString &library, const QString &path)
+{
+    StartupTimes times;
+    QElapsedTimer clock;
+    clock.start();
+
+    auto window = new MainWindow();
+    times.constructor = clock.elapsed();
+
+    FirstPaintFilter paintFilter(window, clock, times.timeToWindow);
+    QCoreApplication::instance()->installEventFilter(&paintFilter);
+
+    const auto treeWidget = window->findChild<MangaTreeWidget *>();
+    const QTreeView *treeView = treeWidget ? treeWidget->treeView() : nullptr;
+    View *view = window->findChild<View *>();
+
+    QEventLoop loop;
+    auto finished = [&times, &library, &path]() {
+        return times.timeToInteractive >= 0 && (library.isEmpty() || times.timeToLibrary >= 0)
+            && (path.isEmpty() || times.timeToFirstPage >= 0);
+    };
+
+    qint64 lastProbe = clock.elapsed();
+    qint64 quietSince{-1};
+    QTimer probe;
+    probe.setTimerType(Qt::PreciseTimer);
+    probe.setInterval(ProbeInterval);
+    QObject::connect(&probe, &QTimer::timeout, &loop, [&]() {
+        const qint64 now = clock.elapsed();
+        if (now - lastProbe > ProbeInterval + LongTask) {
+            // a long task just ended
+            quietSince = now;
+        }
+        lastProbe = now;
+
+        if (times.timeToWindow >= 0) {
+            quietSince = qMax(quietSince, times.timeToWindow);
+            if (times.timeToInteractive < 0 && now - quietSince >= QuietWindow) {
+                times.timeToInteractive = quietSince;
+            }
+        }
+        if (!library.isEmpty() && times.timeToLibrary < 0 && isLibraryListed(treeView)) {
+            times.timeToLibrary = now;
+        }
+        if (!path.isEmpty() && times.timeToFirstPage < 0 && view && isPageShown(view)) {
+            times.timeToFirstPage = now;
+        }
+        if (finished()) {
+            loop.quit();
+        }
+    });
+
+    window->show();
+    if (!path.isEmpty()) {
+        window->setCurrentPath(path);
+        window->loadImages(path);
+    }
+
+    probe.start();
+    QTimer::singleShot(MilestoneTimeout, &loop, &QEventLoop::quit);
+    loop.exec();
+    QCoreApplication::instance()->removeEventFilter(&paintFilter);
+
+    delete window;
+    // run the deferred deletes of the window's children before the next start
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    return times;
+}
+
+int main(int argc, char *argv[])
+{
+    // no window is shown, runs on machines without a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // the generated library and bookmarks don't touch the user's configuration
+    QStandardPaths::setTestModeEnabled(true);
+
+    QApplication app(argc, argv);
+    // the ui files are looked up under the app's name
+    QApplication::setApplicationName(u"mangareader"_s);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Measures how long the reader takes to show its window, become usable and show the first page."_s);
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"path"_s, u"Manga opened on startup, like a command line argument of the reader"_s, u"[path]"_s);
+    QCommandLineOption libraryOption(u"library"_s, u"Manga library folder shown in the tree"_s, u"folder"_s);
+    QCommandLineOption bookmarksOption(u"bookmarks"_s, u"Number of bookmarks to mangas in the library (default 200)"_s, u"count"_s, u"200"_s);
+    QCommandLineOption runsOption(u"runs"_s, u"Number of startups, the first one is also reported on its own (default 5)"_s, u"count"_s, u"5"_s);
+    QCommandLineOption outputOption({u"o"_s, u"output"_s}, u"Write the report to this file instead of stdout"_s, u"file"_s);
+    QCommandLineOption baselineOption(u"baseline"_s, u"Compare against an earlier report"_s, u"file"_s);
+    QCommandLineOption thresholdOption(u"threshold"_s, u"Slowdown reported as a regression (default 0.1, 10%)"_s, u"ratio"_s, u"0.1"_s);
+    parser.addOptions({libraryOption, bookmarksOption, runsOption, outputOption, baselineOption, thresholdOption});
+    parser.process(app);
+
+    const QString library = parser.isSet(libraryOption) ? QFileInfo(parser.value(libraryOption)).absoluteFilePath() : QString();
+    const QString path = parser.positionalArguments().isEmpty() ? QString() : QFileInfo(parser.positionalArguments().first()).absoluteFilePath();
+    const int runs = qMax(1, parser.value(runsOption).toInt());
+
+    setupConfig(library, parser.value(bookmarksOption).toInt());
+
+    LatencyStats constructor;
+    LatencyStats timeToWindow;
+    LatencyStats timeToInteractive;
+    LatencyStats timeToLibrary;
+    LatencyStats timeToFirstPage;
+    QJsonObject firstRun{{u"name"_s, u"first run"_s}};
+    // a milestone not reached is a failure, not a duration to compare
+    QJsonArray missed;
+    for (int run = 0; run < runs; ++run) {
+        QTextStream(stderr) << "Startup " << run + 1 << "/" << runs << "\n";
+        const StartupTimes times = start(library, path);
+        auto add = [run, &firstRun, &missed](const QString &milestone, LatencyStats &stats, qint64 msecs, bool expected) {
+            if (!expected) {
+                return;
+            }
+            if (msecs < 0) {
+                missed.append(QJsonObject{{u"run"_s, run + 1}, {u"milestone"_s, milestone}});
+                return;
+            }
+            stats.add(msecs);
+            // later startups find the icon theme, color schemes and files cached
+            if (run == 0) {
+                firstRun.insert(milestone, msecs);
+            }
+        };
+        add(u"constructor"_s, constructor, times.constructor, true);
+        add(u"timeToWindow"_s, timeToWindow, times.timeToWindow, true);
+        add(u"timeToInteractive"_s, timeToInteractive, times.timeToInteractive, true);
+        add(u"timeToLibrary"_s, timeToLibrary, times.timeToLibrary, !library.isEmpty());
+        add(u"timeToFirstPage"_s, timeToFirstPage, times.timeToFirstPage, !path.isEmpty());
+    }
+
+    QJsonObject startup{
+        {u"name"_s, u"startup"_s},
+        {u"constructor"_s, BenchUtils::toJson(constructor)},
+        {u"timeToWindow"_s, BenchUtils::toJson(timeToWindow)},
+        {u"timeToInteractive"_s, BenchUtils::toJson(timeToInteractive)},
+    };
+    if (!library.isEmpty()) {
+        startup.insert(u"timeToLibrary"_s, BenchUtils::toJson(timeToLibrary));
+    }
+    if (!path.isEmpty()) {
+        startup.insert(u"timeToFirstPage"_s, BenchUtils::toJson(timeToFirstPage));
+    }
+
+    QJsonObject report{
+        {u"tool"_s, u"mangareader-startup-bench"_s},
+        {u"version"_s, 1},
+        {u"library"_s, library},
+        {u"bookmarks"_s, parser.value(bookmarksOption).toInt()},
+        {u"path"_s, path},
+        {u"runs"_s, runs},
+        {u"results"_s, QJsonArray{firstRun, startup}},
+    };
+    if (!missed.isEmpty()) {
+        report.insert(u"missed"_s, missed);
+    }
+
+    int exitCode{0};
+    if (parser.isSet(baselineOption)) {
+        const QJsonArray regressions = BenchUtils::findRegressions(report,
+                                                                   BenchUtils::readJson(parser.value(baselineOption)),
+                                                                   parser.value(thresholdOption).toDouble());
+        report.insert(u"regressions"_s, regressions);
+        for (const QJsonValue &regression : regressions) {
+            QTextStream(stderr) << "Regression: " << regression[u"name"_s].toString() << " " << regression[u"metric"_s].toString() << " "
+                                << regression[u"baseline"_s].toDouble() << " -> " << regression[u"current"_s].toDouble() << "\n";
+        }
+        exitCode = regressions.isEmpty() ? 0 : 2;
+    }
+
+    for (const QJsonValue &milestone : std::as_const(missed)) {
+        QTextStream(stderr) << "Missed: " << milestone[u"milestone"_s].toString() << " in startup " << milestone[u"run"_s].toInt() << "\n";
+        exitCode = 3;
+    }
+
+    if (!BenchUtils::writeJson(report, parser.value(outputOption))) {
+        return 1;
+    }
+    return exitCode;
+}
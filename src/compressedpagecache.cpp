@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "compressedpagecache.h"
+
+#include <cstring>
+
+#include <QMutexLocker>
+
+#ifdef WITH_LZ4
+#include <lz4.h>
+#endif
+
+CompressedPageCache::CompressedPageCache(qint64 maxCost)
+    : m_maxCost{maxCost}
+{
+}
+
+void CompressedPageCache::setMaxCost(qint64 maxCost)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxCost = maxCost;
+    trim();
+}
+
+qint64 CompressedPageCache::totalCost() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalCost;
+}
+
+int CompressedPageCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.count();
+}
+
+void CompressedPageCache::insert(int pageNumber, const ImagePyramid &pyramid)
+{
+    if (pyramid.isNull()) {
+        return;
+    }
+
+    // the smaller levels are rebuilt on decompression
+    const QImage &image = pyramid.base();
+    Entry entry;
+    entry.data = compress(image);
+    entry.size = image.size();
+    entry.bytesPerLine = image.bytesPerLine();
+    entry.format = image.format();
+    entry.fullResolution = pyramid.isFullResolution();
+    if (entry.data.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (entry.data.size() > m_maxCost) {
+        return;
+    }
+    auto it = m_entries.find(pageNumber);
+    if (it != m_entries.end()) {
+        m_totalCost -= it->data.size();
+    }
+    m_totalCost += entry.data.size();
+    entry.lastUse = ++m_useCounter;
+    m_entries.insert(pageNumber, entry);
+    trim();
+}
+
+ImagePyramid CompressedPageCache::take(int pageNumber)
+{
+    Entry entry;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(pageNumber);
+        if (it == m_entries.end()) {
+            return {};
+        }
+        entry = it.value();
+        m_totalCost -= entry.data.size();
+        m_entries.erase(it);
+    }
+
+    QImage image(entry.size, entry.format);
+    if (image.isNull() || image.bytesPerLine() != entry.bytesPerLine || !decompress(entry.data, image)) {
+        return {};
+    }
+    return ImagePyramid(image, entry.fullResolution);
+}
+
+void CompressedPageCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_totalCost = 0;
+}
+
+QByteArray CompressedPageCache::compress(const QImage &image)
+{
+    const auto source = reinterpret_cast<const char *>(image.constBits());
+    const qsizetype sourceSize = image.sizeInBytes();
+#ifdef WITH_LZ4
+    QByteArray data(LZ4_compressBound(static_cast<int>(sourceSize)), Qt::Uninitialized);
+    const int size = LZ4_compress_default(source, data.data(), static_cast<int>(sourceSize), static_cast<int>(data.size()));
+    if (size <= 0) {
+        return {};
+    }
+    data.resize(size);
+    data.squeeze();
+    return data;
+#else
+    return qCompress(reinterpret_cast<const uchar *>(source), sourceSize, 1);
+#endif
+}
+
+bool CompressedPageCache::decompress(const QByteArray &data, QImage &image)
+{
+    const auto destination = reinterpret_cast<char *>(image.bits());
+    const qsizetype destinationSize = image.sizeInBytes();
+#ifdef WITH_LZ4
+    const int size = LZ4_decompress_safe(data.constData(), destination, static_cast<int>(data.size()), static_cast<int>(destinationSize));
+    return size == destinationSize;
+#else
+    const QByteArray pixels = qUncompress(data);
+    if (pixels.size() != destinationSize) {
+        return false;
+    }
+    memcpy(destination, pixels.constData(), destinationSize);
+    return true;
+#endif
+}
+
+void CompressedPageCache::trim()
+{
+    while (m_totalCost > m_maxCost && !m_entries.isEmpty()) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) {
+                oldest = it;
+            }
+        }
+        m_totalCost -= oldest->data.size();
+        m_entries.erase(oldest);
+    }
+}
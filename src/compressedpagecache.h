@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef COMPRESSEDPAGECACHE_H
+#define COMPRESSEDPAGECACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+
+#include "imagepyramid.h"
+
+/**
+ * Second tier of the page cache, holds pages evicted from the PageCache
+ * compressed with LZ4 (zlib when built without LZ4).
+ * Manga pages are mostly flat tones, so they compress very well and
+ * decompressing is much cheaper than extracting and decoding them again.
+ */
+class CompressedPageCache
+{
+public:
+    explicit CompressedPageCache(qint64 maxCost = 128 * 1024 * 1024);
+
+    void setMaxCost(qint64 maxCost);
+    qint64 totalCost() const;
+    int count() const;
+
+    /**
+     * Compresses the largest level of `pyramid`, slow, call it from a worker thread
+     */
+    void insert(int pageNumber, const ImagePyramid &pyramid);
+    /**
+     * Removes the page from the cache and returns it decompressed
+     */
+    ImagePyramid take(int pageNumber);
+    void clear();
+
+private:
+    struct Entry {
+        QByteArray data;
+        QSize size;
+        qsizetype bytesPerLine{0};
+        QImage::Format format{QImage::Format_Invalid};
+        bool fullResolution{false};
+        quint64 lastUse{0};
+    };
+
+    static QByteArray compress(const QImage &image);
+    static bool decompress(const QByteArray &data, QImage &image);
+    void trim();
+
+    mutable QMutex m_mutex;
+    QHash<int, Entry> m_entries;
+    qint64 m_maxCost{0};
+    qint64 m_totalCost{0};
+    quint64 m_useCounter{0};
+};
+
+#endif // COMPRESSEDPAGECACHE_H
@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "coverloader.h"
+
+#include <QCollator>
+#include <QDirListing>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPixmap>
+#include <QtConcurrent>
+
+#include "extractor.h"
+#include "libraryindex.h"
+#include "thumbnailcache.h"
+#include "trace.h"
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+// covers scrolled past long ago are not worth making anymore
+constexpr qsizetype MaxQueued{256};
+// KiB of covers kept in memory, the others are read from the thumbnail cache again
+constexpr int MaxCacheCost{64 * 1024};
+// a series folder takes the cover of its first volume, how deep that is looked for
+constexpr int MaxFolderDepth{2};
+// entries of a series folder tried before giving up
+constexpr int MaxFolderEntries{3};
+
+bool isRar(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == u"rar" || suffix == u"cbr";
+}
+}
+
+CoverLoader::CoverLoader(QObject *parent)
+    : QObject{parent}
+{
+    setObjectName(u"CoverLoader"_s);
+    // one thread is enough to keep up with scrolling once most covers are cached,
+    // and leaves the cores to the page decoding
+    m_pool.setMaxThreadCount(1);
+    m_pool.setThreadPriority(QThread::LowestPriority);
+    m_covers.setMaxCost(MaxCacheCost);
+}
+
+CoverLoader::~CoverLoader()
+{
+    m_stop.request_stop();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void CoverLoader::setUnrarPath(const QString &path)
+{
+    if (path == m_unrarPath) {
+        return;
+    }
+    m_unrarPath = path;
+    // rar archives had no cover without unrar, they get another chance
+    const QSet<QString> missing = m_missing;
+    for (const QString &missingPath : missing) {
+        if (isRar(missingPath)) {
+            m_missing.remove(missingPath);
+            Q_EMIT coverReady(missingPath);
+        }
+    }
+}
+
+QIcon CoverLoader::cover(const QString &path)
+{
+    if (const QIcon *icon = m_covers.object(path)) {
+        return *icon;
+    }
+    if (m_missing.contains(path)) {
+        return {};
+    }
+
+    if (m_queued.contains(path)) {
+        // asked for again, it's still on screen, make it before the others
+        if (m_queue.removeOne(path)) {
+            m_queue.append(path);
+        }
+        return {};
+    }
+    m_queued.insert(path);
+    m_queue.append(path);
+    if (m_queue.size() > MaxQueued) {
+        m_queued.remove(m_queue.takeFirst());
+    }
+    startNext();
+    return {};
+}
+
+void CoverLoader::invalidate(const QString &path)
+{
+    const bool removed = m_covers.remove(path);
+    if (m_missing.remove(path) || removed) {
+        Q_EMIT coverReady(path);
+    }
+}
+
+void CoverLoader::clearQueue()
+{
+    for (const QString &path : std::as_const(m_queue)) {
+        m_queued.remove(path);
+    }
+    m_queue.clear();
+}
+
+void CoverLoader::startNext()
+{
+    while (m_running < m_pool.maxThreadCount() && !m_queue.isEmpty()) {
+        const QString path = m_queue.takeLast();
+        ++m_running;
+        QtConcurrent::run(&m_pool, [path, unrarPath = m_unrarPath, stopToken = m_stop.get_token()]() {
+            return load(path, unrarPath, stopToken);
+        }).then(this, [this, path](const QImage &image) {
+            --m_running;
+            m_queued.remove(path);
+            if (image.isNull()) {
+                m_missing.insert(path);
+            } else {
+                m_covers.insert(path, new QIcon(QPixmap::fromImage(image)), qMax(1, static_cast<int>(image.sizeInBytes() / 1024)));
+            }
+            Q_EMIT coverReady(path);
+            startNext();
+        });
+    }
+}
+
+QImage CoverLoader::load(const QString &path, const QString &unrarPath, std::stop_token stopToken)
+{
+    TRACE_SCOPE("loadCover", -1);
+    return load(path, unrarPath, 0, stopToken);
+}
+
+QImage CoverLoader::load(const QString &path, const QString &unrarPath, int depth, std::stop_token stopToken)
+{
+    const ThumbnailCache cache = QFileInfo(path).isDir() ? ThumbnailCache::folderCovers() : ThumbnailCache::shared();
+    QImage cover = cache.find(path);
+    if (!cover.isNull() || cache.hasFailed(path)) {
+        return cover;
+    }
+
+    cover = make(path, unrarPath, depth, stopToken);
+    if (stopToken.stop_requested()) {
+        return cover;
+    }
+    if (!cover.isNull()) {
+        cache.insert(path, cover);
+    } else if (!isRar(path) || !unrarPath.isEmpty()) {
+        // rar archives get another chance once unrar is installed
+        cache.insertFailure(path);
+    }
+    return cover;
+}
+
+QImage CoverLoader::make(const QString &path, const QString &unrarPath, int depth, std::stop_token stopToken)
+{
+    const QSize maxSize{ThumbnailCache::size(), ThumbnailCache::size()};
+    if (!QFileInfo(path).isDir()) {
+        Extractor extractor;
+        extractor.setUnrarPath(unrarPath);
+        // a rar archive is not extracted, only its first image is
+        if (!extractor.open(path, false)) {
+            return {};
+        }
+        return extractor.extractFirstImage(maxSize);
+    }
+
+    // a folder of images shows its first page
+    QStringList files;
+    for (const QDirListing::DirEntry &entry : QDirListing(path, QDirListing::IteratorFlag::FilesOnly)) {
+        files.append(entry.fileName());
+    }
+    QStringList images = Extractor::filterImages(files);
+    if (!images.isEmpty()) {
+        QCollator collator;
+        collator.setNumericMode(true);
+        std::sort(images.begin(), images.end(), collator);
+        QImageReader reader(path + u'/' + images.first());
+        return Extractor::readScaled(reader, maxSize);
+    }
+
+    // a series folder shows the cover of its first volume
+    if (depth >= MaxFolderDepth) {
+        return {};
+    }
+    const LibraryIndex::Directory directory = LibraryIndex::scanDirectory(path);
+    for (qsizetype i = 0; i < qMin<qsizetype>(directory.entries.size(), MaxFolderEntries); ++i) {
+        if (stopToken.stop_requested()) {
+            return {};
+        }
+        const QImage cover = load(path + u'/' + directory.entries.at(i).name, unrarPath, depth + 1, stopToken);
+        if (!cover.isNull()) {
+            return cover;
+        }
+    }
+    return {};
+}
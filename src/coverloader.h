@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef COVERLOADER_H
+#define COVERLOADER_H
+
+#include <QCache>
+#include <QIcon>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include <stop_token>
+
+/**
+ * Cover thumbnails of archives and folders, the first image they contain.
+ *
+ * Covers are read from the ThumbnailCache, only the missing ones are made,
+ * with a reduced size decode. That work runs on a pool of its own with a single
+ * lowest priority thread, so it never takes a thread from the page decoding.
+ * The covers asked for last are made first, when scrolling through the library
+ * the ones scrolled past are the last to be made or dropped.
+ */
+class CoverLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CoverLoader(QObject *parent = nullptr);
+    ~CoverLoader() override;
+
+    void setUnrarPath(const QString &path);
+
+    /**
+     * The cover of `path` when it's loaded, otherwise a null icon
+     * and the cover is loaded, coverReady() is emitted once it is
+     */
+    QIcon cover(const QString &path);
+    /**
+     * Forgets the cover of `path`, or that it has none,
+     * it's made again the next time it's asked for
+     */
+    void invalidate(const QString &path);
+    /**
+     * Drops the covers not being made yet
+     */
+    void clearQueue();
+
+    /**
+     * Reads the cover from the thumbnail cache, or makes and saves it.
+     * A null image when `path` has no image.
+     */
+    static QImage load(const QString &path, const QString &unrarPath, std::stop_token stopToken = {});
+
+Q_SIGNALS:
+    void coverReady(const QString &path);
+
+private:
+    static QImage make(const QString &path, const QString &unrarPath, int depth, std::stop_token stopToken);
+    static QImage load(const QString &path, const QString &unrarPath, int depth, std::stop_token stopToken);
+    void startNext();
+
+    QThreadPool m_pool;
+    std::stop_source m_stop;
+    QString m_unrarPath;
+    // most recent last
+    QStringList m_queue;
+    QSet<QString> m_queued;
+    int m_running{0};
+    QCache<QString, QIcon> m_covers;
+    // archives and folders without images
+    QSet<QString> m_missing;
+};
+
+#endif // COVERLOADER_H
@@ -0,0 +1,216 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "diskcache.h"
+
+#include <cstring>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr char Magic[4]{'M', 'R', 'P', 'C'};
+constexpr quint32 Version{1};
+// pixels start at a page boundary so they can be mapped directly
+constexpr qint64 HeaderSize{4096};
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint64 bytesPerLine;
+    qint32 format;
+};
+
+void deleteMappedFile(void *info)
+{
+    // destroying the file removes the mapping
+    delete static_cast<QFile *>(info);
+}
+}
+
+DiskCache *DiskCache::self()
+{
+    static DiskCache cache;
+    return &cache;
+}
+
+DiskCache::DiskCache()
+    : m_path{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/pages"_s}
+{
+}
+
+QString DiskCache::path() const
+{
+    return m_path;
+}
+
+qint64 DiskCache::maxSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxSize;
+}
+
+void DiskCache::setMaxSize(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxSize = bytes;
+    if (m_totalSize >= 0) {
+        trim();
+    }
+}
+
+QByteArray DiskCache::fingerprint(const QString &path)
+{
+    const QFileInfo fi(path);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fi.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(fi.size()));
+    hash.addData(QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+    return hash.result().toHex();
+}
+
+QString DiskCache::fileName(const QByteArray &fingerprint, const QString &entry, const QSize &size, QImage::Format format) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fingerprint);
+    hash.addData(entry.toUtf8());
+    hash.addData(u"%1x%2:%3"_s.arg(size.width()).arg(size.height()).arg(static_cast<int>(format)).toUtf8());
+    return m_path + u"/"_s + QString::fromLatin1(hash.result().toHex()) + u".page"_s;
+}
+
+QImage DiskCache::find(const QByteArray &fingerprint, const QString &entry, const QSize &size, QImage::Format format)
+{
+    auto file = new QFile(fileName(fingerprint, entry, size, format));
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
+        return {};
+    }
+
+    Header header;
+    const bool validHeader = file->read(reinterpret_cast<char *>(&header), sizeof(Header)) == sizeof(Header)
+        && memcmp(header.magic, Magic, sizeof(Magic)) == 0
+        && header.version == Version
+        && header.width == size.width()
+        && header.height == size.height()
+        && header.format == static_cast<qint32>(format)
+        && file->size() == HeaderSize + header.bytesPerLine * header.height;
+    if (!validHeader) {
+        delete file;
+        return {};
+    }
+
+    uchar *data = file->map(HeaderSize, header.bytesPerLine * header.height);
+    if (data == nullptr) {
+        delete file;
+        return {};
+    }
+
+    // used as access time for the LRU eviction
+    file->setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    // the image can outlive this thread, the file must not be tied to it
+    file->moveToThread(nullptr);
+
+    return QImage(static_cast<const uchar *>(data), header.width, header.height, header.bytesPerLine,
+                  format, deleteMappedFile, file);
+}
+
+bool DiskCache::insert(const QByteArray &fingerprint, const QString &entry, const QImage &image)
+{
+    if (image.isNull()) {
+        return false;
+    }
+
+    const QString name = fileName(fingerprint, entry, image.size(), image.format());
+    if (QFileInfo::exists(name)) {
+        return true;
+    }
+
+    QDir().mkpath(m_path);
+    const qint64 fileSize = HeaderSize + image.bytesPerLine() * image.height();
+
+    QMutexLocker locker(&m_mutex);
+    if (fileSize > m_maxSize) {
+        return false;
+    }
+
+    Header header;
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.width = image.width();
+    header.height = image.height();
+    header.bytesPerLine = image.bytesPerLine();
+    header.format = static_cast<qint32>(image.format());
+
+    // written to a temporary file and renamed on commit,
+    // a crash can't leave a half written page behind
+    QSaveFile file(name);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QByteArray headerData(HeaderSize, '\0');
+    memcpy(headerData.data(), &header, sizeof(Header));
+    file.write(headerData);
+    file.write(reinterpret_cast<const char *>(image.constBits()), image.bytesPerLine() * image.height());
+    if (!file.commit()) {
+        return false;
+    }
+
+    if (m_totalSize < 0) {
+        scan();
+    } else {
+        m_totalSize += fileSize;
+    }
+    trim();
+
+    return true;
+}
+
+void DiskCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    QDir(m_path).removeRecursively();
+    m_totalSize = 0;
+}
+
+void DiskCache::scan()
+{
+    m_totalSize = 0;
+    QDirIterator it(m_path, {u"*.page"_s}, QDir::Files);
+    while (it.hasNext()) {
+        it.next();
+        m_totalSize += it.fileInfo().size();
+    }
+}
+
+void DiskCache::trim()
+{
+    if (m_totalSize <= m_maxSize) {
+        return;
+    }
+
+    QFileInfoList files = QDir(m_path).entryInfoList({u"*.page"_s}, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &fi : std::as_const(files)) {
+        if (m_totalSize <= m_maxSize) {
+            break;
+        }
+        // files still mapped by an image stay valid until unmapped
+        if (QFile::remove(fi.absoluteFilePath())) {
+            m_totalSize -= fi.size();
+        }
+    }
+}
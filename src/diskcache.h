@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+/**
+ * Persistent cache of pages already scaled to their final size.
+ *
+ * Each page is stored uncompressed after a page aligned header,
+ * so it can be memory mapped straight into a QImage without decoding.
+ * Files are written through QSaveFile (atomic rename) and the least
+ * recently used ones are removed when the cache grows over its size limit.
+ */
+class DiskCache
+{
+public:
+    static DiskCache *self();
+
+    QString path() const;
+    qint64 maxSize() const;
+    void setMaxSize(qint64 bytes);
+
+    /**
+     * Identifies a version of a file, changes when the file is modified
+     */
+    static QByteArray fingerprint(const QString &path);
+
+    QImage find(const QByteArray &fingerprint, const QString &entry, const QSize &size, QImage::Format format);
+    bool insert(const QByteArray &fingerprint, const QString &entry, const QImage &image);
+    void clear();
+
+private:
+    DiskCache();
+    QString fileName(const QByteArray &fingerprint, const QString &entry, const QSize &size, QImage::Format format) const;
+    void scan();
+    void trim();
+
+    QString m_path;
+    mutable QMutex m_mutex;
+    qint64 m_maxSize{1024LL * 1024 * 1024};
+    qint64 m_totalSize{-1};
+};
+
+#endif // DISKCACHE_H
@@ -6,7 +6,9 @@
 
 #include "extractor.h"
 
+#include <QBuffer>
 #include <QCollator>
+#include <QFile>
 #include <QFileInfo>
 #include <QImage>
 #include <QMimeDatabase>
@@ -24,10 +26,26 @@
 #include <K7Zip>
 #endif
 
-#include "settings.h"
-
 using namespace Qt::StringLiterals;
 
+namespace
+{
+void listFiles(const QString &prefix, const KArchiveDirectory *directory, QStringList &files)
+{
+    const QStringList names = directory->entries();
+    for (const QString &name : names) {
+        const KArchiveEntry *entry = directory->entry(name);
+        if (entry->isDirectory()) {
+            if (name != u"__MACOSX") {
+                listFiles(prefix + name + u'/', static_cast<const KArchiveDirectory *>(entry), files);
+            }
+        } else {
+            files.append(prefix + name);
+        }
+    }
+}
+}
+
 Extractor::Extractor(QObject *parent)
     : QObject{parent}
 {
@@ -42,7 +60,7 @@ Extractor::~Extractor()
     }
 }
 
-bool Extractor::open(const QString &path)
+bool Extractor::open(const QString &path, bool extractRar)
 {
     m_archive.reset();
 
@@ -50,16 +68,24 @@ bool Extractor::open(const QString &path)
     m_archiveFile = path;
     m_archiveMimeType = db.mimeTypeForFile(path, QMimeDatabase::MatchContent);
 
+    // archives read into memory are opened from a buffer, never touching the disk again
+    const bool inMemory = !isRar() && readArchiveIntoMemory();
+    if (inMemory) {
+        m_archiveBuffer = std::make_unique<QBuffer>(&m_archiveData);
+    }
+
     if (isZip()) {
-        m_archive = std::make_unique<KZip>(path);
+        m_archive = inMemory ? std::make_unique<KZip>(m_archiveBuffer.get()) : std::make_unique<KZip>(path);
 #ifdef WITH_K7ZIP
     } else if (is7Z()) {
-        m_archive = std::make_unique<K7Zip>(path);
+        m_archive = inMemory ? std::make_unique<K7Zip>(m_archiveBuffer.get()) : std::make_unique<K7Zip>(path);
 #endif
     } else if (isTar()) {
-        m_archive = std::make_unique<KTar>(path);
+        m_archive = inMemory ? std::make_unique<KTar>(m_archiveBuffer.get()) : std::make_unique<KTar>(path);
     } else if (isRar()) {
-        extractRarArchive();
+        if (extractRar) {
+            extractRarArchive();
+        }
         return true;
     } else {
         return false;
@@ -73,6 +99,72 @@ bool Extractor::open(const QString &path)
     return true;
 }
 
+void Extractor::setLoadIntoMemory(bool enabled, qint64 maxSize)
+{
+    m_loadIntoMemory = enabled;
+    m_maxInMemorySize = maxSize;
+}
+
+bool Extractor::readArchiveIntoMemory()
+{
+    if (!m_loadIntoMemory) {
+        m_inMemoryFile.clear();
+        m_archiveData.clear();
+        return false;
+    }
+    if (m_inMemoryFile == m_archiveFile) {
+        return true;
+    }
+
+    m_inMemoryFile.clear();
+    m_archiveData.clear();
+
+    QFile file(m_archiveFile);
+    if (file.size() > m_maxInMemorySize || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    // read in chunks so a cancelled open doesn't have to wait for the whole file
+    static constexpr qint64 ChunkSize{4 * 1024 * 1024};
+    m_archiveData.resize(file.size());
+    qint64 offset{0};
+    while (offset < m_archiveData.size()) {
+        if (m_stopToken.stop_requested()) {
+            m_archiveData.clear();
+            return false;
+        }
+        const qint64 read = file.read(m_archiveData.data() + offset, qMin<qint64>(ChunkSize, m_archiveData.size() - offset));
+        if (read <= 0) {
+            break;
+        }
+        offset += read;
+    }
+    if (offset != file.size()) {
+        qDebug() << i18n("Could not read archive into memory: %1", m_archiveFile) << file.errorString();
+        m_archiveData.clear();
+        return false;
+    }
+    m_inMemoryFile = m_archiveFile;
+    return true;
+}
+
+void Extractor::setUnrarPath(const QString &path)
+{
+    m_unrarPath = path;
+}
+
+void Extractor::setStopToken(std::stop_token token)
+{
+    m_stopToken = std::move(token);
+}
+
+void Extractor::abortRar()
+{
+    if (m_process && m_process->state() != QProcess::NotRunning) {
+        disconnect(m_process.get(), nullptr, this, nullptr);
+        m_process->kill();
+    }
+}
+
 QList<Image> Extractor::filesList()
 {
     if (m_archiveFile.isEmpty()) {
@@ -92,6 +184,9 @@ QList<Image> Extractor::filesList()
     }
 
     auto files = getFiles(QString(), m_archive->directory());
+    if (m_stopToken.stop_requested()) {
+        return {};
+    }
     QCollator collator;
     collator.setNumericMode(true);
     std::sort(files.begin(), files.end(), [&collator](const Image &a, const Image &b) {
@@ -104,9 +199,7 @@ QList<Image> Extractor::filesList()
 void Extractor::extractRarArchive()
 {
     m_tmpFolder = std::make_unique<QTemporaryDir>();
-    auto unrar = MangaReaderSettings::unrarPath().isEmpty()
-                ? MangaReaderSettings::autoUnrarPath()
-                : MangaReaderSettings::unrarPath();
+    const QString unrar = m_unrarPath;
     if (unrar.isEmpty()) {
         return;
     }
@@ -227,16 +320,15 @@ QByteArray Extractor::getFileData(const QString &name)
     return archiveFile->data();
 }
 
-QImage Extractor::extractFirstImage()
+QImage Extractor::extractFirstImage(const QSize &maxSize)
 {
     if (m_archiveFile.isEmpty()) {
         qDebug() << i18n("No archive file set");
         return QImage();
     }
-    qDebug() << "Extracting first image:" << m_archiveFile;
     // archive is passed to MangaLoader and deleted there
     if (m_archive == nullptr && isRar()) {
-        return rarExtractFirstImage();
+        return rarExtractFirstImage(maxSize);
     }
     if (m_archive == nullptr) {
         qDebug() << i18n("Unknown archive: %1", m_archiveFile);
@@ -249,26 +341,32 @@ QImage Extractor::extractFirstImage()
         return QImage();
     }
 
-    auto files = getFiles(QString(), m_archive->directory());
-    if (files.isEmpty()) {
+    // only the names, getFiles() reads the size of every image
+    QStringList files;
+    listFiles(QString(), directory, files);
+    auto images = filterImages(files);
+    if (images.isEmpty()) {
         return QImage();
     }
 
     QCollator collator;
     collator.setNumericMode(true);
-    std::sort(files.begin(), files.end(), [&collator](const Image &a, const Image &b) {
-        return collator.compare(a.path, b.path) < 0;
-    });
-
-    auto *file = directory->file(files.first().path);
+    std::sort(images.begin(), images.end(), collator);
 
-    return QImage::fromData(file->data());
+    const KArchiveFile *file = directory->file(images.first());
+    if (file == nullptr) {
+        return QImage();
+    }
+    QByteArray data = file->data();
+    QBuffer buffer(&data);
+    QImageReader reader(&buffer);
+    return readScaled(reader, maxSize);
 }
 
-QImage Extractor::rarExtractFirstImage()
+QImage Extractor::rarExtractFirstImage(const QSize &maxSize)
 {
     m_tmpFolder = std::make_unique<QTemporaryDir>();
-    auto unrar = QStandardPaths::findExecutable(u"unrar"_s);
+    auto unrar = m_unrarPath.isEmpty() ? QStandardPaths::findExecutable(u"unrar"_s) : m_unrarPath;
     if (unrar.isEmpty()) {
         return QImage();
     }
@@ -306,7 +404,18 @@ QImage Extractor::rarExtractFirstImage()
     process.start();
     process.waitForFinished();
 
-    return QImage(m_tmpFolder->path() + u"/"_s + images.first());
+    QImageReader reader(m_tmpFolder->path() + u"/"_s + images.first());
+    return readScaled(reader, maxSize);
+}
+
+QImage Extractor::readScaled(QImageReader &reader, const QSize &maxSize)
+{
+    reader.setAutoTransform(true);
+    const QSize size = reader.size();
+    if (maxSize.isValid() && size.isValid() && (size.width() > maxSize.width() || size.height() > maxSize.height())) {
+        reader.setScaledSize(size.scaled(maxSize, Qt::KeepAspectRatio));
+    }
+    return reader.read();
 }
 
 QStringList Extractor::filterImages(const QStringList &files)
@@ -337,6 +446,10 @@ QList<Image> Extractor::getFiles(const QString &prefix, const KArchiveDirectory
     QList<Image> files;
     const QStringList entryList = dir->entries();
     for (const QString &file : entryList) {
+        // reading the size of each image is what makes listing big archives slow
+        if (m_stopToken.stop_requested()) {
+            return files;
+        }
         const KArchiveEntry *e = dir->entry(file);
         if (e->isDirectory()) {
             if (e->name() == u"__MACOSX") {
@@ -13,8 +13,12 @@
 
 #include <KArchive>
 
+#include <stop_token>
+
 #include "image.h"
 
+class QBuffer;
+class QImageReader;
 class QProcess;
 class KArchiveDirectory;
 
@@ -26,7 +30,29 @@ public:
     explicit Extractor(QObject *parent = nullptr);
     ~Extractor();
 
-    bool open(const QString &path);
+    /**
+     * Rar archives are extracted to a temporary folder, unless `extractRar` is false,
+     * extractFirstImage() can still read them then
+     */
+    bool open(const QString &path, bool extractRar = true);
+    /**
+     * Reads archives up to `maxSize` bytes into memory in one sequential pass
+     * when opened, all entries are then read from memory
+     */
+    void setLoadIntoMemory(bool enabled, qint64 maxSize);
+    /**
+     * Path of the unrar executable used to extract rar archives
+     */
+    void setUnrarPath(const QString &path);
+    /**
+     * Once a stop is requested through `token`, reading the archive
+     * into memory and listing its files return early
+     */
+    void setStopToken(std::stop_token token);
+    /**
+     * Kills the unrar process if it's running, without waiting for it
+     */
+    void abortRar();
     QList<Image> filesList();
     void extractRarArchive();
     /**
@@ -43,18 +69,24 @@ public:
     QByteArray getFileData(const QString &name);
     /*
      * Extracts the first image from an archive, before image is extracted
-     * files are natural sorted and filtered to have only images
+     * files are natural sorted and filtered to have only images.
+     * When `maxSize` is valid the image is decoded scaled down to fit in it.
      */
-    QImage extractFirstImage();
+    QImage extractFirstImage(const QSize &maxSize = {});
     /*
      * Extracts the first image from a rar archive, before image is extracted
      * files are natural sorted and filtered to have only images
      */
-    QImage rarExtractFirstImage();
+    QImage rarExtractFirstImage(const QSize &maxSize = {});
+    /**
+     * Decodes the image of `reader` scaled down to fit in `maxSize`,
+     * formats like jpeg skip most of the decoding work then
+     */
+    static QImage readScaled(QImageReader &reader, const QSize &maxSize);
     /*
      * Takes all files from an archive and returns only supported images
      */
-    QStringList filterImages(const QStringList &files);
+    static QStringList filterImages(const QStringList &files);
     QString extractionFolder();
     QString unrarNotFoundMessage();
 
@@ -73,11 +105,20 @@ Q_SIGNALS:
 
 private:
     QList<Image> getFiles(const QString &prefix, const KArchiveDirectory *dir);
+    bool readArchiveIntoMemory();
     QString m_archiveFile;
+    QString m_unrarPath;
+    bool m_loadIntoMemory{false};
+    qint64 m_maxInMemorySize{0};
+    QString m_inMemoryFile;
+    QByteArray m_archiveData;
+    // declared before the archive reading from it, so it is destroyed after it
+    std::unique_ptr<QBuffer> m_archiveBuffer;
     std::unique_ptr<KArchive> m_archive;
     std::unique_ptr<QTemporaryDir> m_tmpFolder;
     std::unique_ptr<QProcess> m_process;
     QMimeType m_archiveMimeType;
+    std::stop_token m_stopToken;
 };
 
 #endif // EXTRACTOR_H
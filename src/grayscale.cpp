@@ -0,0 +1,93 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "grayscale.h"
+
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GRAYSCALE_SSE2 1
+#endif
+
+// maximum difference between the color channels of a pixel still considered gray
+static constexpr int ChannelTolerance{8};
+
+static bool isGrayRow(const QRgb *pixels, int count)
+{
+    int i = 0;
+#ifdef GRAYSCALE_SSE2
+    const __m128i tolerance = _mm_set1_epi8(ChannelTolerance);
+    // per pixel only the |b - g| and |g - r| bytes are kept
+    const __m128i mask = _mm_set1_epi32(0x0000ffff);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        const __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        const __m128i gra = _mm_srli_epi32(bgra, 8);
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(bgra, gra), _mm_subs_epu8(gra, bgra));
+        const __m128i overTolerance = _mm_subs_epu8(_mm_and_si128(diff, mask), tolerance);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(overTolerance, zero)) != 0xffff) {
+            return false;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        const int r = qRed(pixels[i]);
+        const int g = qGreen(pixels[i]);
+        const int b = qBlue(pixels[i]);
+        if (std::abs(r - g) > ChannelTolerance || std::abs(g - b) > ChannelTolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Grayscale::isGrayscale(const QImage &image)
+{
+    if (image.isNull()) {
+        return false;
+    }
+
+    switch (image.format()) {
+    case QImage::Format_Grayscale8:
+        return true;
+    case QImage::Format_RGB32:
+        break;
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        // transparency can't be kept in a grayscale image
+        if (image.hasAlphaChannel()) {
+            return false;
+        }
+        break;
+    default:
+        return image.allGray();
+    }
+
+    for (int y = 0; y < image.height(); ++y) {
+        if (!isGrayRow(reinterpret_cast<const QRgb *>(image.constScanLine(y)), image.width())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QImage Grayscale::convertIfGrayscale(const QImage &image)
+{
+    if (image.format() == QImage::Format_Grayscale8 || !isGrayscale(image)) {
+        return image;
+    }
+    return image.convertToFormat(QImage::Format_Grayscale8);
+}
+
+QImage Grayscale::scaled(const QImage &image, const QSize &size, Qt::AspectRatioMode aspectMode)
+{
+    QImage result = image.scaled(size, aspectMode, Qt::SmoothTransformation);
+    if (image.format() == QImage::Format_Grayscale8 && result.format() != QImage::Format_Grayscale8) {
+        result.convertTo(QImage::Format_Grayscale8);
+    }
+    return result;
+}
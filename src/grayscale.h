@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef GRAYSCALE_H
+#define GRAYSCALE_H
+
+#include <QImage>
+
+namespace Grayscale
+{
+/**
+ * Checks if all pixels are gray, allowing the small channel
+ * differences jpeg compression leaves in black and white pages
+ */
+bool isGrayscale(const QImage &image);
+
+/**
+ * Returns `image` as Format_Grayscale8 if it has no color,
+ * otherwise returns it unchanged
+ */
+QImage convertIfGrayscale(const QImage &image);
+
+/**
+ * Scales `image` keeping it Format_Grayscale8 if it was,
+ * Qt's smooth scaling always returns a 32 bit image
+ */
+QImage scaled(const QImage &image, const QSize &size, Qt::AspectRatioMode aspectMode = Qt::IgnoreAspectRatio);
+}
+
+#endif // GRAYSCALE_H
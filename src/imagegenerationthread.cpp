@@ -6,11 +6,16 @@
 
 #include "imagegenerationthread.h"
 
+#include <QElapsedTimer>
+
 #include "manga.h"
+#include "trace.h"
 
 ImageGenerationThread::ImageGenerationThread(Manga *manga)
     : m_manga{manga}
-{}
+{
+    setObjectName(u"image generation"_s);
+}
 
 void ImageGenerationThread::startGeneration(ImageRequest *request)
 {
@@ -30,7 +35,17 @@ ImageRequest *ImageGenerationThread::request() const
 
 void ImageGenerationThread::run()
 {
-    if (m_request) {
-        m_request->image = m_manga->image(m_request);
+    // whoever asked for it is no longer interested
+    if (m_request && !m_request->promise.isCanceled()) {
+        QElapsedTimer timer;
+        timer.start();
+        {
+            TRACE_SCOPE("image", m_request->pageNumber);
+            m_request->image = m_manga->image(m_request);
+        }
+        m_request->decodeTime = timer.elapsed();
+    }
+    if (m_request && Trace::isEnabled()) {
+        m_request->finishedAt = Trace::now();
     }
 }
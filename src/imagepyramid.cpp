@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "imagepyramid.h"
+#include "grayscale.h"
+
+// levels smaller than this are not worth keeping,
+// scaling from the level above is cheap enough
+static constexpr int MinimumLevelWidth{256};
+static constexpr int MaximumLevels{4};
+
+ImagePyramid::ImagePyramid(const QImage &image, bool fullResolution)
+    : m_fullResolution{fullResolution}
+{
+    if (image.isNull()) {
+        return;
+    }
+
+    m_levels.append(image);
+    while (m_levels.size() < MaximumLevels) {
+        const QImage &previous = m_levels.constLast();
+        if (previous.width() / 2 < MinimumLevelWidth) {
+            break;
+        }
+        m_levels.append(Grayscale::scaled(previous, previous.size() / 2));
+    }
+}
+
+bool ImagePyramid::isNull() const
+{
+    return m_levels.isEmpty();
+}
+
+bool ImagePyramid::isFullResolution() const
+{
+    return m_fullResolution;
+}
+
+bool ImagePyramid::canServe(const QSize &size) const
+{
+    if (isNull()) {
+        return false;
+    }
+    // the original image can't get any sharper, upscaling it is what a decode would do
+    if (m_fullResolution) {
+        return true;
+    }
+    return size.width() <= base().width() && size.height() <= base().height();
+}
+
+QSize ImagePyramid::size() const
+{
+    return isNull() ? QSize{} : base().size();
+}
+
+const QImage &ImagePyramid::base() const
+{
+    return m_levels.constFirst();
+}
+
+qsizetype ImagePyramid::sizeInBytes() const
+{
+    qsizetype bytes{0};
+    for (const QImage &level : m_levels) {
+        bytes += level.sizeInBytes();
+    }
+    return bytes;
+}
+
+QImage ImagePyramid::scaled(const QSize &size) const
+{
+    if (isNull() || size.isEmpty()) {
+        return {};
+    }
+
+    // levels go from biggest to smallest, pick the last one still big enough
+    const QImage *source = &m_levels.constFirst();
+    for (const QImage &level : m_levels) {
+        if (level.width() < size.width() || level.height() < size.height()) {
+            break;
+        }
+        source = &level;
+    }
+
+    if (source->size() == size) {
+        return *source;
+    }
+    return Grayscale::scaled(*source, size);
+}
@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include <QImage>
+#include <QList>
+#include <QSize>
+
+/**
+ * Keeps a decoded page at its largest decoded size plus power-of-two
+ * reductions, so zoom changes can be served by resampling the nearest
+ * level instead of decoding the page again.
+ */
+class ImagePyramid
+{
+public:
+    ImagePyramid() = default;
+    /**
+     * `fullResolution` tells if `image` is the page at its original size,
+     * in which case the pyramid can serve any requested size
+     */
+    ImagePyramid(const QImage &image, bool fullResolution);
+
+    bool isNull() const;
+    bool isFullResolution() const;
+    bool canServe(const QSize &size) const;
+    QSize size() const;
+    const QImage &base() const;
+    qsizetype sizeInBytes() const;
+    /**
+     * Resamples the smallest level that is at least as big as `size`
+     */
+    QImage scaled(const QSize &size) const;
+
+private:
+    QList<QImage> m_levels;
+    bool m_fullResolution{false};
+};
+
+#endif // IMAGEPYRAMID_H
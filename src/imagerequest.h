@@ -7,16 +7,59 @@
 #ifndef IMAGEREQUEST_H
 #define IMAGEREQUEST_H
 
+#include <QHashFunctions>
 #include <QImage>
+#include <QPromise>
+#include <QRect>
 #include <QSize>
 #include <QString>
 
+#include "pageimage.h"
+
 struct ImageRequest {
     int pageNumber;
     QSize size;
     QString path;
     QImage image;
+    // tiled pages request one tile at a time,
+    // `sourceRect` is the part of the source image the tile covers
+    int tile{-1};
+    QRect sourceRect;
+    // cheap low resolution decode shown until the full quality one is ready
+    bool preview{false};
+    // time spent producing `image`, in milliseconds
+    qint64 decodeTime{0};
+    // higher priority requests are decoded first, the newest among equals
+    int priority{0};
+    // results are also broadcast through Manga's signals, only one such request per page is kept
+    bool emitSignals{false};
+    // Trace::now() when queued and when the worker finished, only set while tracing
+    qint64 queuedAt{-1};
+    qint64 finishedAt{-1};
+    QPromise<PageImage> promise;
+};
+
+/**
+ * Identifies what a request produces, a newer request
+ * with the same key replaces a pending one
+ */
+struct ImageRequestKey {
+    int pageNumber;
+    int tile;
+    bool preview;
+
+    friend bool operator==(const ImageRequestKey &a, const ImageRequestKey &b) = default;
 };
 
+inline size_t qHash(const ImageRequestKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.pageNumber, key.tile, key.preview);
+}
+
+inline ImageRequestKey requestKey(const ImageRequest *request)
+{
+    return {request->pageNumber, request->tile, request->preview};
+}
+
 
 #endif // IMAGEREQUEST_H
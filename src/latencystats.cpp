@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "latencystats.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+LatencyStats::LatencyStats(qsizetype capacity)
+    : m_capacity{capacity}
+{
+}
+
+void LatencyStats::add(qreal msecs)
+{
+    if (m_capacity > 0 && m_samples.size() == m_capacity) {
+        // ring buffer, overwrite the oldest sample
+        m_samples[m_next] = msecs;
+        m_next = (m_next + 1) % m_capacity;
+        return;
+    }
+    m_samples.append(msecs);
+}
+
+void LatencyStats::clear()
+{
+    m_samples.clear();
+    m_next = 0;
+}
+
+qsizetype LatencyStats::count() const
+{
+    return m_samples.size();
+}
+
+qreal LatencyStats::mean() const
+{
+    if (m_samples.isEmpty()) {
+        return 0;
+    }
+    qreal sum{0};
+    for (qreal sample : m_samples) {
+        sum += sample;
+    }
+    return sum / m_samples.size();
+}
+
+qreal LatencyStats::max() const
+{
+    if (m_samples.isEmpty()) {
+        return 0;
+    }
+    return *std::max_element(m_samples.cbegin(), m_samples.cend());
+}
+
+qreal LatencyStats::percentile(qreal percentile) const
+{
+    if (m_samples.isEmpty()) {
+        return 0;
+    }
+    QList<qreal> sorted = m_samples;
+    const qsizetype rank = qBound<qsizetype>(1, qCeil(percentile / 100.0 * sorted.size()), sorted.size());
+    std::nth_element(sorted.begin(), sorted.begin() + rank - 1, sorted.end());
+    return sorted.at(rank - 1);
+}
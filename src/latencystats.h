@@ -0,0 +1,38 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QList>
+
+/**
+ * Collects durations, in milliseconds, and reports their distribution.
+ * When `capacity` is set only the newest samples are kept.
+ */
+class LatencyStats
+{
+public:
+    explicit LatencyStats(qsizetype capacity = 0);
+
+    void add(qreal msecs);
+    void clear();
+    qsizetype count() const;
+
+    qreal mean() const;
+    qreal max() const;
+    /**
+     * Nearest rank percentile, `percentile` goes from 0 to 100
+     */
+    qreal percentile(qreal percentile) const;
+
+private:
+    QList<qreal> m_samples;
+    qsizetype m_capacity{0};
+    qsizetype m_next{0};
+};
+
+#endif // LATENCYSTATS_H
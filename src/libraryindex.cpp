@@ -0,0 +1,249 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "libraryindex.h"
+
+#include <QCollator>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirListing>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTimeZone>
+
+#include <algorithm>
+
+#include "trace.h"
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr quint32 Magic{0x4d524c49}; // MRLI
+constexpr quint32 Version{2};
+// times of a folder are trusted only once the listing is this much newer than them
+constexpr qint64 TimeGranularity{2000};
+}
+
+LibraryIndex::LibraryIndex(const QString &rootPath)
+    : m_rootPath{rootPath.isEmpty() ? QString() : QDir::cleanPath(rootPath)}
+{
+}
+
+QString LibraryIndex::rootPath() const
+{
+    return m_rootPath;
+}
+
+bool LibraryIndex::isEmpty() const
+{
+    return m_directories.isEmpty();
+}
+
+qsizetype LibraryIndex::directoryCount() const
+{
+    return m_directories.size();
+}
+
+qsizetype LibraryIndex::archiveCount() const
+{
+    qsizetype count{0};
+    for (const Directory &directory : m_directories) {
+        count += std::count_if(directory.entries.cbegin(), directory.entries.cend(), [](const Entry &entry) {
+            return !entry.isDir;
+        });
+    }
+    return count;
+}
+
+const LibraryIndex::Directory *LibraryIndex::directory(const QString &relativePath) const
+{
+    const auto it = m_directories.constFind(relativePath);
+    return it == m_directories.cend() ? nullptr : &it.value();
+}
+
+QStringList LibraryIndex::directories() const
+{
+    return m_directories.keys();
+}
+
+void LibraryIndex::replaceSubtree(const QString &relativePath, const LibraryIndex &other)
+{
+    const QString prefix = relativePath.isEmpty() ? QString() : relativePath + u'/';
+    m_directories.removeIf([&relativePath, &prefix](QHash<QString, Directory>::iterator it) {
+        return it.key() == relativePath || it.key().startsWith(prefix);
+    });
+    for (auto it = other.m_directories.cbegin(); it != other.m_directories.cend(); ++it) {
+        m_directories.insert(it.key(), it.value());
+    }
+}
+
+QString LibraryIndex::absolutePath(const QString &relativePath) const
+{
+    return relativePath.isEmpty() ? m_rootPath : m_rootPath + u'/' + relativePath;
+}
+
+std::optional<QString> LibraryIndex::relativePath(const QString &absolutePath) const
+{
+    const QString path = QDir::cleanPath(absolutePath);
+    if (m_rootPath.isEmpty()) {
+        return std::nullopt;
+    }
+    if (path == m_rootPath) {
+        return QString();
+    }
+    if (path.startsWith(m_rootPath + u'/')) {
+        return path.mid(m_rootPath.size() + 1);
+    }
+    return std::nullopt;
+}
+
+QString LibraryIndex::childPath(const QString &relativePath, const QString &name)
+{
+    return relativePath.isEmpty() ? name : relativePath + u'/' + name;
+}
+
+LibraryIndex::Directory LibraryIndex::scanDirectory(const QString &path)
+{
+    Directory directory;
+    const QFileInfo info(path);
+    directory.modified = info.lastModified(QTimeZone::UTC).toMSecsSinceEpoch();
+    directory.changed = info.metadataChangeTime(QTimeZone::UTC).toMSecsSinceEpoch();
+    directory.listed = QDateTime::currentMSecsSinceEpoch();
+
+    for (const QDirListing::DirEntry &dirEntry : QDirListing(path, QDirListing::IteratorFlag::Default)) {
+        const bool isDir = dirEntry.isDir();
+        if (!isDir && !isArchive(dirEntry.fileName())) {
+            continue;
+        }
+        directory.entries.append({
+            .name = dirEntry.fileName(),
+            .isDir = isDir,
+            .size = isDir ? 0 : dirEntry.size(),
+            .modified = dirEntry.lastModified(QTimeZone::UTC).toMSecsSinceEpoch(),
+        });
+    }
+
+    QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    std::sort(directory.entries.begin(), directory.entries.end(), [&collator](const Entry &a, const Entry &b) {
+        if (a.isDir != b.isDir) {
+            return a.isDir;
+        }
+        return collator.compare(a.name, b.name) < 0;
+    });
+    return directory;
+}
+
+LibraryIndex LibraryIndex::scan(const QString &rootPath, const LibraryIndex &previous, const QString &from, std::stop_token stopToken)
+{
+    TRACE_SCOPE("scanLibrary", -1);
+
+    LibraryIndex index(rootPath);
+    // symlinked folders can lead back up the tree
+    QSet<QString> visited;
+    QStringList queue{from};
+    while (!queue.isEmpty() && !stopToken.stop_requested()) {
+        const QString relativePath = queue.takeLast();
+        const QString path = index.absolutePath(relativePath);
+        const QFileInfo info(path);
+        if (!info.isDir()) {
+            continue;
+        }
+        if (info.isSymLink() || relativePath == from) {
+            if (visited.contains(info.canonicalFilePath())) {
+                continue;
+            }
+            visited.insert(info.canonicalFilePath());
+        }
+
+        const Directory *known = previous.rootPath() == index.rootPath() && relativePath != from ? previous.directory(relativePath) : nullptr;
+        const bool unchanged = known && known->modified == info.lastModified(QTimeZone::UTC).toMSecsSinceEpoch()
+            && known->changed == info.metadataChangeTime(QTimeZone::UTC).toMSecsSinceEpoch()
+            && known->listed - qMax(known->modified, known->changed) > TimeGranularity;
+        const Directory directory = unchanged ? *known : scanDirectory(path);
+
+        for (const Entry &entry : directory.entries) {
+            if (entry.isDir) {
+                queue.append(childPath(relativePath, entry.name));
+            }
+        }
+        index.m_directories.insert(relativePath, directory);
+    }
+    return index;
+}
+
+bool LibraryIndex::isArchive(const QString &fileName)
+{
+    static const QStringList suffixes{u"zip"_s, u"cbz"_s, u"rar"_s, u"cbr"_s, u"7z"_s, u"cb7"_s, u"tar"_s, u"cbt"_s};
+    const qsizetype dot = fileName.lastIndexOf(u'.');
+    return dot > 0 && suffixes.contains(QStringView(fileName).mid(dot + 1), Qt::CaseInsensitive);
+}
+
+QString LibraryIndex::cachePath(const QString &rootPath)
+{
+    const QByteArray hash = QCryptographicHash::hash(QDir::cleanPath(rootPath).toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/library/"_s + QString::fromLatin1(hash) + u".index"_s;
+}
+
+bool LibraryIndex::save(const QString &path) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << Magic << Version << m_rootPath << static_cast<qint64>(m_directories.size());
+    for (auto it = m_directories.cbegin(); it != m_directories.cend(); ++it) {
+        stream << it.key() << it->modified << it->changed << it->listed << static_cast<qint64>(it->entries.size());
+        for (const Entry &entry : it->entries) {
+            stream << entry.name << entry.isDir << entry.size << entry.modified;
+        }
+    }
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+LibraryIndex LibraryIndex::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QDataStream stream(&file);
+    quint32 magic{0};
+    quint32 version{0};
+    QString rootPath;
+    qint64 directoryCount{0};
+    stream >> magic >> version >> rootPath >> directoryCount;
+    if (magic != Magic || version != Version || stream.status() != QDataStream::Ok) {
+        return {};
+    }
+
+    LibraryIndex index(rootPath);
+    for (qint64 i = 0; i < directoryCount && stream.status() == QDataStream::Ok; ++i) {
+        QString relativePath;
+        Directory directory;
+        qint64 entryCount{0};
+        stream >> relativePath >> directory.modified >> directory.changed >> directory.listed >> entryCount;
+        for (qint64 j = 0; j < entryCount && stream.status() == QDataStream::Ok; ++j) {
+            Entry entry;
+            stream >> entry.name >> entry.isDir >> entry.size >> entry.modified;
+            directory.entries.append(entry);
+        }
+        index.m_directories.insert(relativePath, directory);
+    }
+    // a truncated file is as good as none
+    return stream.status() == QDataStream::Ok ? index : LibraryIndex{};
+}
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef LIBRARYINDEX_H
+#define LIBRARYINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <optional>
+#include <stop_token>
+
+/**
+ * Folders and archives of a manga library, with their sizes and modification times.
+ *
+ * Directories are stored by their path relative to the library folder,
+ * with '/' separators and an empty path for the library folder itself.
+ * The index is saved to the cache folder, so the library can be shown
+ * before it is scanned again.
+ */
+class LibraryIndex
+{
+public:
+    struct Entry {
+        QString name;
+        bool isDir{false};
+        qint64 size{0};
+        // milliseconds since epoch
+        qint64 modified{0};
+    };
+
+    struct Directory {
+        qint64 modified{0};
+        // status change time, a chmod or a rename changes it too
+        qint64 changed{0};
+        // when the entries were listed, a change in the same tick as the listing
+        // leaves the times above as they were
+        qint64 listed{0};
+        // folders first, then archives, in natural order
+        QList<Entry> entries;
+    };
+
+    explicit LibraryIndex(const QString &rootPath = {});
+
+    QString rootPath() const;
+    bool isEmpty() const;
+    qsizetype directoryCount() const;
+    qsizetype archiveCount() const;
+
+    /**
+     * nullptr when the directory is not in the index
+     */
+    const Directory *directory(const QString &relativePath) const;
+    QStringList directories() const;
+
+    /**
+     * Replaces the directories under `relativePath`, itself included, with the ones of `other`
+     */
+    void replaceSubtree(const QString &relativePath, const LibraryIndex &other);
+
+    QString absolutePath(const QString &relativePath) const;
+    /**
+     * std::nullopt when `absolutePath` is not inside the library
+     */
+    std::optional<QString> relativePath(const QString &absolutePath) const;
+    static QString childPath(const QString &relativePath, const QString &name);
+
+    /**
+     * Lists the folders and archives of a single directory
+     */
+    static Directory scanDirectory(const QString &path);
+
+    /**
+     * Walks the directories under `from`. Directories whose modification and status change times
+     * didn't change since `previous` was made are taken from it without being listed again,
+     * unless they changed too close to their listing to tell. `from` itself is always listed,
+     * files changed in place don't touch the times of their folder.
+     */
+    static LibraryIndex scan(const QString &rootPath,
+                             const LibraryIndex &previous,
+                             const QString &from = {},
+                             std::stop_token stopToken = {});
+
+    static bool isArchive(const QString &fileName);
+
+    /**
+     * Where the index of the library at `rootPath` is saved
+     */
+    static QString cachePath(const QString &rootPath);
+    bool save(const QString &path) const;
+    static LibraryIndex load(const QString &path);
+
+private:
+    QString m_rootPath;
+    QHash<QString, Directory> m_directories;
+};
+
+#endif // LIBRARYINDEX_H
@@ -0,0 +1,463 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "librarymodel.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileSystemWatcher>
+#include <QTimeZone>
+#include <QtConcurrent>
+
+#include "coverloader.h"
+
+using namespace Qt::StringLiterals;
+
+// changes usually come in bursts, a copy or an extraction touches a folder many times
+static constexpr int RescanDelay{500};
+static constexpr int SaveDelay{2000};
+// well below the default inotify limit of 8192 watches per user, shared with other programs
+static constexpr qsizetype MaxWatchedDirectories{1024};
+
+LibraryModel::LibraryModel(QObject *parent)
+    : QAbstractItemModel{parent}
+    , m_root{std::make_unique<Node>()}
+    , m_watcher{new QFileSystemWatcher(this)}
+    , m_folderIcon{QIcon::fromTheme(u"folder"_s)}
+    , m_archiveIcon{QIcon::fromTheme(u"application-zip"_s)}
+{
+    m_root->isDir = true;
+
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(RescanDelay);
+    connect(&m_rescanTimer, &QTimer::timeout, this, [this]() {
+        QStringList changed = m_changedDirectories.values();
+        m_changedDirectories.clear();
+        // a rescan covers the subfolders too
+        std::sort(changed.begin(), changed.end());
+        QString previous;
+        for (const QString &path : std::as_const(changed)) {
+            if (!previous.isNull() && (path == previous || path.startsWith(previous + u'/'))) {
+                continue;
+            }
+            if (const auto relativePath = m_index.relativePath(path)) {
+                startScan(*relativePath);
+                previous = path;
+            }
+        }
+    });
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SaveDelay);
+    connect(&m_saveTimer, &QTimer::timeout, this, [this]() {
+        QThreadPool::globalInstance()->start([index = m_index]() {
+            index.save(LibraryIndex::cachePath(index.rootPath()));
+        });
+    });
+
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path) {
+        m_changedDirectories.insert(QDir::cleanPath(path));
+        m_rescanTimer.start();
+    });
+}
+
+LibraryModel::~LibraryModel()
+{
+    m_scanStop.request_stop();
+    if (m_saveTimer.isActive()) {
+        m_index.save(LibraryIndex::cachePath(m_index.rootPath()));
+    }
+}
+
+QString LibraryModel::rootPath() const
+{
+    return m_index.rootPath();
+}
+
+void LibraryModel::setRootPath(const QString &path)
+{
+    const QString rootPath = QDir::cleanPath(path);
+    if (rootPath == m_index.rootPath()) {
+        return;
+    }
+
+    m_scanStop.request_stop();
+    m_scanStop = std::stop_source{};
+    if (m_coverLoader) {
+        m_coverLoader->clearQueue();
+    }
+    if (m_saveTimer.isActive()) {
+        m_saveTimer.stop();
+        m_index.save(LibraryIndex::cachePath(m_index.rootPath()));
+    }
+    m_rescanTimer.stop();
+    m_changedDirectories.clear();
+    m_pendingScans.clear();
+    m_unwatchable.clear();
+    if (!m_watcher->directories().isEmpty()) {
+        m_watcher->removePaths(m_watcher->directories());
+    }
+
+    beginResetModel();
+    m_index = LibraryIndex::load(LibraryIndex::cachePath(rootPath));
+    if (m_index.rootPath() != rootPath) {
+        m_index = LibraryIndex(rootPath);
+    }
+    m_root = std::make_unique<Node>();
+    m_root->isDir = true;
+    if (const LibraryIndex::Directory *directory = m_index.directory(QString())) {
+        for (const LibraryIndex::Entry &entry : directory->entries) {
+            m_root->children.push_back(createNode(entry, entry.name, m_root.get()));
+            m_root->children.back()->row = static_cast<int>(m_root->children.size()) - 1;
+        }
+    }
+    endResetModel();
+    Q_EMIT indexChanged();
+
+    if (!rootPath.isEmpty()) {
+        startScan(QString());
+    }
+}
+
+const LibraryIndex &LibraryModel::libraryIndex() const
+{
+    return m_index;
+}
+
+bool LibraryModel::isScanning() const
+{
+    return m_scanRunning || !m_pendingScans.isEmpty();
+}
+
+QModelIndex LibraryModel::index(const QString &path) const
+{
+    const auto relativePath = m_index.relativePath(path);
+    if (!relativePath || relativePath->isEmpty()) {
+        return {};
+    }
+
+    Node *current = m_root.get();
+    const QStringList names = relativePath->split(u'/');
+    for (const QString &name : names) {
+        const auto it = std::find_if(current->children.cbegin(), current->children.cend(), [&name](const auto &child) {
+            return child->name == name;
+        });
+        if (it == current->children.cend()) {
+            return {};
+        }
+        current = it->get();
+    }
+    return indexOf(current);
+}
+
+QString LibraryModel::filePath(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return {};
+    }
+    return m_index.absolutePath(relativePath(node(index)));
+}
+
+QString LibraryModel::relativePath(const QModelIndex &index) const
+{
+    return index.isValid() ? relativePath(node(index)) : QString();
+}
+
+bool LibraryModel::isDir(const QModelIndex &index) const
+{
+    return node(index)->isDir;
+}
+
+void LibraryModel::setCoverLoader(CoverLoader *loader)
+{
+    if (loader == m_coverLoader) {
+        return;
+    }
+    if (m_coverLoader) {
+        disconnect(m_coverLoader, nullptr, this, nullptr);
+    }
+    m_coverLoader = loader;
+    if (m_coverLoader) {
+        connect(m_coverLoader, &CoverLoader::coverReady, this, [this](const QString &path) {
+            const QModelIndex modelIndex = index(path);
+            if (modelIndex.isValid()) {
+                Q_EMIT dataChanged(modelIndex, modelIndex, {Qt::DecorationRole});
+            }
+        });
+    }
+    // views repaint everything they show for a change spanning several rows
+    if (!m_root->children.empty()) {
+        Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, 0), {Qt::DecorationRole});
+    }
+}
+
+QModelIndex LibraryModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return {};
+    }
+    return createIndex(row, column, node(parent)->children.at(row).get());
+}
+
+QModelIndex LibraryModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return {};
+    }
+    return indexOf(node(child)->parent);
+}
+
+int LibraryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    return static_cast<int>(node(parent)->children.size());
+}
+
+int LibraryModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+bool LibraryModel::hasChildren(const QModelIndex &parent) const
+{
+    return rowCount(parent) > 0;
+}
+
+QVariant LibraryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return {};
+    }
+
+    const Node *item = node(index);
+    switch (role) {
+    case Qt::DisplayRole:
+        return item->name;
+    case Qt::DecorationRole:
+        if (m_coverLoader) {
+            if (const QIcon cover = m_coverLoader->cover(filePath(index)); !cover.isNull()) {
+                return cover;
+            }
+        }
+        return item->isDir ? m_folderIcon : m_archiveIcon;
+    case PathRole:
+        return filePath(index);
+    case IsDirRole:
+        return item->isDir;
+    case SizeRole:
+        return item->size;
+    case ModifiedRole:
+        return QDateTime::fromMSecsSinceEpoch(item->modified, QTimeZone::UTC);
+    }
+    return {};
+}
+
+LibraryModel::Node *LibraryModel::node(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Node *>(index.internalPointer()) : m_root.get();
+}
+
+QModelIndex LibraryModel::indexOf(Node *node) const
+{
+    if (node == nullptr || node == m_root.get()) {
+        return {};
+    }
+    return createIndex(node->row, 0, node);
+}
+
+QString LibraryModel::relativePath(const Node *node) const
+{
+    return node ? node->path : QString();
+}
+
+std::unique_ptr<LibraryModel::Node> LibraryModel::createNode(const LibraryIndex::Entry &entry, const QString &relativePath, Node *parent) const
+{
+    auto node = std::make_unique<Node>();
+    node->name = entry.name;
+    node->path = relativePath;
+    node->parent = parent;
+    node->isDir = entry.isDir;
+    node->size = entry.size;
+    node->modified = entry.modified;
+
+    if (const LibraryIndex::Directory *directory = entry.isDir ? m_index.directory(relativePath) : nullptr) {
+        node->children.reserve(directory->entries.size());
+        for (const LibraryIndex::Entry &childEntry : directory->entries) {
+            node->children.push_back(createNode(childEntry, LibraryIndex::childPath(relativePath, childEntry.name), node.get()));
+            node->children.back()->row = static_cast<int>(node->children.size()) - 1;
+        }
+    }
+    return node;
+}
+
+void LibraryModel::updateChildren(Node *node, const QString &relativePath)
+{
+    const LibraryIndex::Directory *directory = m_index.directory(relativePath);
+    const QList<LibraryIndex::Entry> entries = directory ? directory->entries : QList<LibraryIndex::Entry>{};
+    const QModelIndex parentIndex = indexOf(node);
+    auto &children = node->children;
+    auto renumber = [&children](std::size_t from) {
+        for (std::size_t i = from; i < children.size(); ++i) {
+            children[i]->row = static_cast<int>(i);
+        }
+    };
+
+    // removed, or an archive replaced by a folder of the same name
+    QHash<QString, bool> kept;
+    for (const LibraryIndex::Entry &entry : entries) {
+        kept.insert(entry.name, entry.isDir);
+    }
+    for (int row = static_cast<int>(children.size()) - 1; row >= 0; --row) {
+        const auto it = kept.constFind(children[row]->name);
+        if (it == kept.cend() || it.value() != children[row]->isDir) {
+            beginRemoveRows(parentIndex, row, row);
+            children.erase(children.begin() + row);
+            renumber(row);
+            endRemoveRows();
+        }
+    }
+
+    // both lists are in the same order, what is left of the old one is a subsequence of the new one
+    int row{0};
+    while (row < entries.size()) {
+        const LibraryIndex::Entry &entry = entries.at(row);
+        if (static_cast<std::size_t>(row) < children.size() && children[row]->name == entry.name) {
+            Node *child = children[row].get();
+            if (child->size != entry.size || child->modified != entry.modified) {
+                child->size = entry.size;
+                child->modified = entry.modified;
+                // the archive changed, so may have its cover
+                if (m_coverLoader && !child->isDir) {
+                    m_coverLoader->invalidate(m_index.absolutePath(child->path));
+                }
+                Q_EMIT dataChanged(indexOf(child), indexOf(child));
+            }
+            if (child->isDir) {
+                updateChildren(child, LibraryIndex::childPath(relativePath, entry.name));
+            }
+            ++row;
+            continue;
+        }
+
+        // new entries up to the next existing one are inserted together
+        const QString next = static_cast<std::size_t>(row) < children.size() ? children[row]->name : QString();
+        int last = row;
+        while (last + 1 < entries.size() && (next.isNull() || entries.at(last + 1).name != next)) {
+            ++last;
+        }
+        beginInsertRows(parentIndex, row, last);
+        std::vector<std::unique_ptr<Node>> created;
+        for (int i = row; i <= last; ++i) {
+            created.push_back(createNode(entries.at(i), LibraryIndex::childPath(relativePath, entries.at(i).name), node));
+        }
+        children.insert(children.begin() + row, std::make_move_iterator(created.begin()), std::make_move_iterator(created.end()));
+        renumber(row);
+        endInsertRows();
+        row = last + 1;
+    }
+
+    if (children.size() > static_cast<std::size_t>(entries.size())) {
+        beginRemoveRows(parentIndex, static_cast<int>(entries.size()), static_cast<int>(children.size()) - 1);
+        children.erase(children.begin() + entries.size(), children.end());
+        endRemoveRows();
+    }
+}
+
+void LibraryModel::applyIndex(const LibraryIndex &index, const QString &from)
+{
+    m_index.replaceSubtree(from, index);
+
+    // the closest folder already in the tree
+    QString relativePath = from;
+    QModelIndex modelIndex = relativePath.isEmpty() ? QModelIndex{} : this->index(m_index.absolutePath(relativePath));
+    while (!relativePath.isEmpty() && !modelIndex.isValid()) {
+        relativePath = relativePath.contains(u'/') ? relativePath.section(u'/', 0, -2) : QString();
+        modelIndex = relativePath.isEmpty() ? QModelIndex{} : this->index(m_index.absolutePath(relativePath));
+    }
+    updateChildren(node(modelIndex), relativePath);
+
+    updateWatchedPaths();
+    m_saveTimer.start();
+    Q_EMIT indexChanged();
+}
+
+void LibraryModel::startScan(const QString &from)
+{
+    // a pending scan of the folder or of one above it covers this one
+    for (const QString &pending : std::as_const(m_pendingScans)) {
+        if (pending.isEmpty() || from == pending || from.startsWith(pending + u'/')) {
+            return;
+        }
+    }
+    m_pendingScans.removeIf([&from](const QString &pending) {
+        return from.isEmpty() || pending.startsWith(from + u'/');
+    });
+    m_pendingScans.append(from);
+    startNextScan();
+}
+
+void LibraryModel::startNextScan()
+{
+    // one scan at a time, each one starts from what the previous one found
+    // and an older scan can't overwrite what a newer one applied
+    if (m_scanRunning || m_pendingScans.isEmpty()) {
+        return;
+    }
+    const QString from = m_pendingScans.takeFirst();
+    m_scanRunning = true;
+    const std::stop_token stopToken = m_scanStop.get_token();
+    QtConcurrent::run([rootPath = m_index.rootPath(), previous = m_index, from, stopToken]() {
+        return LibraryIndex::scan(rootPath, previous, from, stopToken);
+    }).then(this, [this, from, stopToken](const LibraryIndex &index) {
+        m_scanRunning = false;
+        // the library changed meanwhile
+        if (!stopToken.stop_requested()) {
+            applyIndex(index, from);
+            if (from.isEmpty()) {
+                Q_EMIT scanFinished();
+            }
+        }
+        startNextScan();
+    });
+}
+
+void LibraryModel::updateWatchedPaths()
+{
+    // every watch takes one of the user's inotify watches, only the folders
+    // closest to the library folder are watched, deeper ones are caught up by the next full scan
+    QStringList directories = m_index.directories();
+    if (directories.size() > MaxWatchedDirectories) {
+        std::stable_sort(directories.begin(), directories.end(), [](const QString &a, const QString &b) {
+            return a.count(u'/') + !a.isEmpty() < b.count(u'/') + !b.isEmpty();
+        });
+        directories.resize(MaxWatchedDirectories);
+    }
+    QSet<QString> wanted;
+    for (const QString &relativePath : std::as_const(directories)) {
+        wanted.insert(m_index.absolutePath(relativePath));
+    }
+
+    const QStringList watchedList = m_watcher->directories();
+    const QSet<QString> watched(watchedList.cbegin(), watchedList.cend());
+
+    const QSet<QString> removed = watched - wanted;
+    const QSet<QString> added = wanted - watched - m_unwatchable;
+    if (!removed.isEmpty()) {
+        m_watcher->removePaths(removed.values());
+    }
+    if (!added.isEmpty()) {
+        // out of watches or unreadable, not tried again until the library changes
+        const QStringList failed = m_watcher->addPaths(added.values());
+        if (!failed.isEmpty()) {
+            qWarning() << "Could not watch" << failed.size() << "library folders, changes in them show up on the next start";
+            m_unwatchable.unite(QSet<QString>(failed.cbegin(), failed.cend()));
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef LIBRARYMODEL_H
+#define LIBRARYMODEL_H
+
+#include <QAbstractItemModel>
+#include <QIcon>
+#include <QSet>
+#include <QTimer>
+
+#include <memory>
+#include <stop_token>
+#include <vector>
+
+#include "libraryindex.h"
+
+class CoverLoader;
+class QFileSystemWatcher;
+
+/**
+ * Tree of the folders and archives of a manga library, served from a LibraryIndex.
+ *
+ * The saved index is shown right away, then the library is scanned in the background
+ * and only the differences are applied. Afterwards folders are watched
+ * and rescanned when their content changes.
+ */
+class LibraryModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum {
+        PathRole = Qt::UserRole + 1,
+        IsDirRole,
+        SizeRole,
+        ModifiedRole,
+    };
+
+    explicit LibraryModel(QObject *parent = nullptr);
+    ~LibraryModel() override;
+
+    QString rootPath() const;
+    void setRootPath(const QString &path);
+    const LibraryIndex &libraryIndex() const;
+    bool isScanning() const;
+
+    QModelIndex index(const QString &path) const;
+    QString filePath(const QModelIndex &index) const;
+    /**
+     * Path relative to the library folder, like the ones of the LibraryIndex
+     */
+    QString relativePath(const QModelIndex &index) const;
+    bool isDir(const QModelIndex &index) const;
+    /**
+     * Covers are shown as the icons of the entries while `loader` is set,
+     * they are asked for only when a view shows the entry
+     */
+    void setCoverLoader(CoverLoader *loader);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    bool hasChildren(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+Q_SIGNALS:
+    /**
+     * Emitted when a scan of the whole library was applied
+     */
+    void scanFinished();
+    /**
+     * Emitted after every change of the index, the initial load included
+     */
+    void indexChanged();
+
+private:
+    struct Node {
+        QString name;
+        // relative to the library folder, kept so filtering a big library doesn't build it for every row
+        QString path;
+        Node *parent{nullptr};
+        int row{0};
+        bool isDir{false};
+        qint64 size{0};
+        qint64 modified{0};
+        std::vector<std::unique_ptr<Node>> children;
+    };
+
+    Node *node(const QModelIndex &index) const;
+    QModelIndex indexOf(Node *node) const;
+    QString relativePath(const Node *node) const;
+    std::unique_ptr<Node> createNode(const LibraryIndex::Entry &entry, const QString &relativePath, Node *parent) const;
+    void updateChildren(Node *node, const QString &relativePath);
+    void applyIndex(const LibraryIndex &index, const QString &from);
+    void startScan(const QString &from);
+    void startNextScan();
+    void updateWatchedPaths();
+
+    std::unique_ptr<Node> m_root;
+    LibraryIndex m_index;
+    QFileSystemWatcher *m_watcher{nullptr};
+    std::stop_source m_scanStop;
+    bool m_scanRunning{false};
+    // folders to scan once the running scan is applied
+    QStringList m_pendingScans;
+    QSet<QString> m_unwatchable;
+    QSet<QString> m_changedDirectories;
+    QTimer m_rescanTimer;
+    QTimer m_saveTimer;
+    CoverLoader *m_coverLoader{nullptr};
+    QIcon m_folderIcon;
+    QIcon m_archiveIcon;
+};
+
+#endif // LIBRARYMODEL_H
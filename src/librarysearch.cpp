@@ -0,0 +1,313 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "librarysearch.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QXmlStreamReader>
+
+#include <KArchive>
+#include <KArchiveDirectory>
+#include <KArchiveFile>
+#include <KTar>
+#include <KZip>
+#ifdef WITH_K7ZIP
+#include <K7Zip>
+#endif
+
+#include <algorithm>
+#include <memory>
+
+#include "libraryindex.h"
+#include "trace.h"
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr quint32 Magic{0x4d524c43}; // MRLC
+constexpr quint32 Version{1};
+
+quint64 trigram(QStringView text, qsizetype position)
+{
+    return (quint64(text[position].unicode()) << 32) | (quint64(text[position + 1].unicode()) << 16) | text[position + 2].unicode();
+}
+
+void listFiles(const KArchiveDirectory *directory, const QString &prefix, QStringList &files)
+{
+    const QStringList names = directory->entries();
+    for (const QString &name : names) {
+        const KArchiveEntry *entry = directory->entry(name);
+        if (entry->isDirectory()) {
+            listFiles(static_cast<const KArchiveDirectory *>(entry), prefix + name + u'/', files);
+        } else {
+            files.append(prefix + name);
+        }
+    }
+}
+
+QString comicInfoTitle(const QByteArray &xml)
+{
+    QString series;
+    QString title;
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (reader.name() == u"Series") {
+            series = reader.readElementText();
+        } else if (reader.name() == u"Title") {
+            title = reader.readElementText();
+        }
+    }
+    return u"%1 %2"_s.arg(series, title).trimmed();
+}
+}
+
+LibrarySearch LibrarySearch::build(const LibraryIndex &index, const ContentsMap &contents, std::stop_token stopToken)
+{
+    TRACE_SCOPE("buildSearch", -1);
+
+    LibrarySearch search;
+    QStringList directories = index.directories();
+    std::sort(directories.begin(), directories.end());
+    for (const QString &directoryPath : std::as_const(directories)) {
+        if (stopToken.stop_requested()) {
+            return {};
+        }
+        const LibraryIndex::Directory *directory = index.directory(directoryPath);
+        for (const LibraryIndex::Entry &entry : directory->entries) {
+            const QString path = LibraryIndex::childPath(directoryPath, entry.name);
+            QString text = entry.name.toCaseFolded();
+            if (const auto it = contents.constFind(path);
+                !entry.isDir && it != contents.cend() && it->size == entry.size && it->modified == entry.modified) {
+                text += u'\n' + it->title.toCaseFolded() + u'\n' + it->entries.join(u'\n').toCaseFolded();
+            }
+
+            const auto id = static_cast<qint32>(search.m_paths.size());
+            QSet<quint64> trigrams;
+            for (qsizetype i = 0; i + 2 < text.size(); ++i) {
+                if (text[i] == u'\n' || text[i + 1] == u'\n' || text[i + 2] == u'\n') {
+                    continue;
+                }
+                trigrams.insert(trigram(text, i));
+            }
+            // ids only grow, posting lists stay sorted
+            for (quint64 key : std::as_const(trigrams)) {
+                search.m_trigrams[key].append(id);
+            }
+            search.m_paths.append(path);
+            search.m_texts.append(text);
+        }
+    }
+    return search;
+}
+
+bool LibrarySearch::isEmpty() const
+{
+    return m_paths.isEmpty();
+}
+
+qsizetype LibrarySearch::size() const
+{
+    return m_paths.size();
+}
+
+QList<qint32> LibrarySearch::search(const QString &query) const
+{
+    const QStringList queryWords = words(query);
+    if (queryWords.isEmpty()) {
+        return {};
+    }
+
+    QList<const QList<qint32> *> postings;
+    for (const QString &word : queryWords) {
+        for (qsizetype i = 0; i + 2 < word.size(); ++i) {
+            const auto it = m_trigrams.constFind(trigram(word, i));
+            if (it == m_trigrams.cend()) {
+                return {};
+            }
+            postings.append(&it.value());
+        }
+    }
+
+    // only words shorter than a trigram, every entry has to be compared
+    if (postings.isEmpty()) {
+        QList<qint32> results;
+        for (qint32 id = 0; id < m_texts.size(); ++id) {
+            if (matches(id, queryWords)) {
+                results.append(id);
+            }
+        }
+        return results;
+    }
+
+    std::sort(postings.begin(), postings.end(), [](const QList<qint32> *a, const QList<qint32> *b) {
+        return a->size() < b->size();
+    });
+    QList<qint32> candidates = *postings.constFirst();
+    QList<qint32> intersection;
+    for (qsizetype i = 1; i < postings.size() && !candidates.isEmpty(); ++i) {
+        intersection.clear();
+        std::set_intersection(candidates.cbegin(), candidates.cend(), postings.at(i)->cbegin(), postings.at(i)->cend(),
+                              std::back_inserter(intersection));
+        candidates.swap(intersection);
+    }
+    // having all the trigrams of a word doesn't mean having the word
+    return refine(query, candidates);
+}
+
+QList<qint32> LibrarySearch::refine(const QString &query, const QList<qint32> &candidates) const
+{
+    const QStringList queryWords = words(query);
+    if (queryWords.isEmpty()) {
+        return {};
+    }
+
+    QList<qint32> results;
+    for (qint32 id : candidates) {
+        if (id < m_texts.size() && matches(id, queryWords)) {
+            results.append(id);
+        }
+    }
+    return results;
+}
+
+QString LibrarySearch::path(qint32 id) const
+{
+    return m_paths.value(id);
+}
+
+QStringList LibrarySearch::words(const QString &query)
+{
+    return query.toCaseFolded().split(u' ', Qt::SkipEmptyParts);
+}
+
+bool LibrarySearch::matches(qint32 id, const QStringList &words) const
+{
+    const QString &text = m_texts.at(id);
+    return std::all_of(words.cbegin(), words.cend(), [&text](const QString &word) {
+        return text.contains(word);
+    });
+}
+
+LibrarySearch::ContentsMap LibrarySearch::readArchiveContents(const LibraryIndex &index, const ContentsMap &previous, std::stop_token stopToken)
+{
+    TRACE_SCOPE("readArchiveContents", -1);
+
+    ContentsMap contents;
+    const QStringList directories = index.directories();
+    for (const QString &directoryPath : directories) {
+        const LibraryIndex::Directory *directory = index.directory(directoryPath);
+        for (const LibraryIndex::Entry &entry : directory->entries) {
+            if (stopToken.stop_requested()) {
+                return contents;
+            }
+            if (entry.isDir) {
+                continue;
+            }
+            const QString path = LibraryIndex::childPath(directoryPath, entry.name);
+            if (const auto it = previous.constFind(path);
+                it != previous.cend() && it->size == entry.size && it->modified == entry.modified) {
+                contents.insert(path, it.value());
+                continue;
+            }
+            // archives that can't be read are remembered too, so they are not tried again
+            ArchiveContents archiveContents = readArchiveContents(index.absolutePath(path));
+            archiveContents.size = entry.size;
+            archiveContents.modified = entry.modified;
+            contents.insert(path, archiveContents);
+        }
+    }
+    return contents;
+}
+
+LibrarySearch::ArchiveContents LibrarySearch::readArchiveContents(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    std::unique_ptr<KArchive> archive;
+    if (suffix == u"zip" || suffix == u"cbz") {
+        archive = std::make_unique<KZip>(path);
+    } else if (suffix == u"tar" || suffix == u"cbt") {
+        archive = std::make_unique<KTar>(path);
+#ifdef WITH_K7ZIP
+    } else if (suffix == u"7z" || suffix == u"cb7") {
+        archive = std::make_unique<K7Zip>(path);
+#endif
+    }
+    // rar archives need unrar, running it for every archive of the library is too slow
+    if (!archive || !archive->open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    ArchiveContents contents;
+    listFiles(archive->directory(), QString(), contents.entries);
+    for (const QString &name : std::as_const(contents.entries)) {
+        if (name.compare(u"ComicInfo.xml"_s, Qt::CaseInsensitive) == 0) {
+            const KArchiveFile *file = archive->directory()->file(name);
+            // a normal one is a few KiB
+            if (file && file->size() < 1024 * 1024) {
+                contents.title = comicInfoTitle(file->data());
+            }
+            break;
+        }
+    }
+    return contents;
+}
+
+QString LibrarySearch::contentsCachePath(const QString &rootPath)
+{
+    const QFileInfo indexFile(LibraryIndex::cachePath(rootPath));
+    return indexFile.path() + u'/' + indexFile.completeBaseName() + u".contents"_s;
+}
+
+bool LibrarySearch::saveContents(const ContentsMap &contents, const QString &path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << Magic << Version << static_cast<qint64>(contents.size());
+    for (auto it = contents.cbegin(); it != contents.cend(); ++it) {
+        stream << it.key() << it->size << it->modified << it->title << it->entries;
+    }
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+LibrarySearch::ContentsMap LibrarySearch::loadContents(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QDataStream stream(&file);
+    quint32 magic{0};
+    quint32 version{0};
+    qint64 count{0};
+    stream >> magic >> version >> count;
+    if (magic != Magic || version != Version) {
+        return {};
+    }
+
+    ContentsMap contents;
+    for (qint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString archivePath;
+        ArchiveContents archiveContents;
+        stream >> archivePath >> archiveContents.size >> archiveContents.modified >> archiveContents.title >> archiveContents.entries;
+        contents.insert(archivePath, archiveContents);
+    }
+    return stream.status() == QDataStream::Ok ? contents : ContentsMap{};
+}
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef LIBRARYSEARCH_H
+#define LIBRARYSEARCH_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <stop_token>
+
+class LibraryIndex;
+
+/**
+ * Trigram index over the folders and archives of a library, built from a LibraryIndex.
+ *
+ * A query matches the entries containing all of its words, case insensitive,
+ * in their name or, when known, in the title and file names inside the archive.
+ * Words of three characters or more are looked up in the trigram index
+ * and only the candidates it gives are compared.
+ */
+class LibrarySearch
+{
+public:
+    /**
+     * What is inside an archive, read once and kept while the archive doesn't change
+     */
+    struct ArchiveContents {
+        qint64 size{0};
+        qint64 modified{0};
+        // Series and Title of ComicInfo.xml
+        QString title;
+        QStringList entries;
+    };
+    using ContentsMap = QHash<QString, ArchiveContents>;
+
+    static LibrarySearch build(const LibraryIndex &index, const ContentsMap &contents = {}, std::stop_token stopToken = {});
+
+    bool isEmpty() const;
+    qsizetype size() const;
+
+    /**
+     * Ids of the matching entries, in the order of the library index
+     */
+    QList<qint32> search(const QString &query) const;
+    /**
+     * Like search(), but only `candidates` are considered. When the user keeps typing,
+     * the results of the shorter query are the candidates of the longer one.
+     */
+    QList<qint32> refine(const QString &query, const QList<qint32> &candidates) const;
+    /**
+     * Path of the entry relative to the library folder
+     */
+    QString path(qint32 id) const;
+
+    /**
+     * Lists the archives of the library missing from `previous` or changed since,
+     * the others are taken from it. Rar archives are not read.
+     */
+    static ContentsMap readArchiveContents(const LibraryIndex &index, const ContentsMap &previous, std::stop_token stopToken = {});
+    static ArchiveContents readArchiveContents(const QString &path);
+    static QString contentsCachePath(const QString &rootPath);
+    static bool saveContents(const ContentsMap &contents, const QString &path);
+    static ContentsMap loadContents(const QString &path);
+
+private:
+    static QStringList words(const QString &query);
+    bool matches(qint32 id, const QStringList &words) const;
+
+    QStringList m_paths;
+    // case folded name, title and entries, separated by new lines
+    QStringList m_texts;
+    QHash<quint64, QList<qint32>> m_trigrams;
+};
+
+#endif // LIBRARYSEARCH_H
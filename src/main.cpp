@@ -6,7 +6,12 @@
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QUrl>
 
 #include <KAboutData>
@@ -14,9 +19,31 @@
 
 #include "mainwindow.h"
 #include "mangareader-version.h"
+#include "requestscheduler.h"
+#include "stallwatchdog.h"
+#include "trace.h"
+
+/**
+ * Logs how long a startup milestone took to reach and, when `path` is set,
+ * rewrites the JSON report there with every milestone reached so far
+ */
+static void recordStartup(const QString &path, const QString &milestone, qint64 msecs)
+{
+    static QJsonObject report;
+    report.insert(milestone, msecs);
+    qInfo().noquote() << u"Startup: %1 after %2 ms"_s.arg(milestone).arg(msecs);
+
+    QFile file(path);
+    if (!path.isEmpty() && file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QJsonDocument(report).toJson());
+    }
+}
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     /**
      * enable dark mode for title bar on Windows
      */
@@ -54,13 +81,64 @@ int main(int argc, char *argv[])
 
     QCommandLineParser parser;
     parser.addPositionalArgument(QStringLiteral("file"), i18n("File or folder to open"));
+    QCommandLineOption traceOption(QStringLiteral("trace"),
+                                   i18n("Write a Chrome trace of page loading to the file, also enabled by MANGAREADER_TRACE"),
+                                   i18n("file"));
+    parser.addOption(traceOption);
+    QCommandLineOption stallThresholdOption(QStringLiteral("stall-threshold"),
+                                            i18n("Log every time the interface doesn't respond for longer than this, "
+                                                 "also set by MANGAREADER_STALL_THRESHOLD"),
+                                            i18n("milliseconds"));
+    parser.addOption(stallThresholdOption);
+    QCommandLineOption startupReportOption(QStringLiteral("startup-report"),
+                                           i18n("Log the startup times and write them to the file, "
+                                                "also enabled by MANGAREADER_STARTUP_REPORT"),
+                                           i18n("file"));
+    parser.addOption(startupReportOption);
+    QCommandLineOption schedulerOption(QStringLiteral("scheduler"),
+                                       i18n("Order pages are decoded in: lifo (default), distance or velocity, "
+                                            "also set by MANGAREADER_SCHEDULER"),
+                                       i18n("policy"));
+    parser.addOption(schedulerOption);
     parser.process(app);
     aboutData.setupCommandLine(&parser);
     aboutData.processCommandLine(&parser);
 
+    const QString tracePath = parser.isSet(traceOption) ? parser.value(traceOption) : qEnvironmentVariable("MANGAREADER_TRACE");
+    Trace::start(tracePath);
+    StallWatchdog::start(parser.isSet(stallThresholdOption) ? parser.value(stallThresholdOption).toInt()
+                                                             : qEnvironmentVariableIntValue("MANGAREADER_STALL_THRESHOLD"));
+
+    const QString schedulerName = parser.isSet(schedulerOption) ? parser.value(schedulerOption) : qEnvironmentVariable("MANGAREADER_SCHEDULER");
+    if (!schedulerName.isEmpty()) {
+        if (const auto policy = RequestScheduler::policyFromName(schedulerName)) {
+            RequestScheduler::setDefaultPolicy(*policy);
+        } else {
+            qWarning() << "Unknown scheduler" << schedulerName << "using" << RequestScheduler::policyName(RequestScheduler::defaultPolicy());
+        }
+    }
+
     const QStringList args = parser.positionalArguments();
 
+    const bool reportStartup = parser.isSet(startupReportOption) || qEnvironmentVariableIsSet("MANGAREADER_STARTUP_REPORT");
+    const QString startupReportPath = parser.isSet(startupReportOption) ? parser.value(startupReportOption)
+                                                                        : qEnvironmentVariable("MANGAREADER_STARTUP_REPORT");
+
     auto w = new MainWindow();
+    if (reportStartup) {
+        QObject::connect(w, &MainWindow::firstFrameShown, w, [&startupTimer, startupReportPath]() {
+            recordStartup(startupReportPath, u"timeToWindow"_s, startupTimer.elapsed());
+        });
+        QObject::connect(w, &MainWindow::startupFinished, w, [&startupTimer, startupReportPath]() {
+            recordStartup(startupReportPath, u"timeToInteractive"_s, startupTimer.elapsed());
+        });
+        // without a manga to open, the first page is whatever the user opens later
+        if (args.count() > 0 && !args.at(0).isEmpty()) {
+            QObject::connect(w, &MainWindow::firstPageShown, w, [&startupTimer, startupReportPath]() {
+                recordStartup(startupReportPath, u"timeToFirstPage"_s, startupTimer.elapsed());
+            });
+        }
+    }
     w->show();
 
     if (args.count() > 0 && !args.at(0).isEmpty()) {
@@ -69,6 +147,9 @@ int main(int argc, char *argv[])
         w->loadImages(url.toLocalFile());
     }
 
-    return QApplication::exec();
+    const int exitCode = QApplication::exec();
+    StallWatchdog::stop();
+    Trace::stop();
+    return exitCode;
 }
 
@@ -14,7 +14,6 @@
 #include <QDockWidget>
 #include <QFile>
 #include <QFileDialog>
-#include <QFileSystemModel>
 #include <QHeaderView>
 #include <QMenuBar>
 #include <QMessageBox>
@@ -28,6 +27,7 @@
 #include <QStandardItemModel>
 #include <QTableView>
 #include <QThread>
+#include <QTimer>
 #include <QTreeView>
 #include <QVBoxLayout>
 
@@ -51,6 +51,7 @@
 #include "settings.h"
 #include "settingswindow.h"
 #include "startupwidget.h"
+#include "trace.h"
 #include "view.h"
 
 MainWindow::MainWindow(QWidget *parent)
@@ -63,6 +64,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_bookmarksView{ new QTableView() }
     , m_bookmarksModel{ new QStandardItemModel(0, 2, this) }
 {
+    TRACE_SCOPE("MainWindow", -1);
     setFocus(Qt::ActiveWindowFocusReason);
     setAcceptDrops(true);
     init();
@@ -100,7 +102,8 @@ MainWindow::MainWindow(QWidget *parent)
         toggleFullScreen();
     }
 
-    Q_EMIT constructorFinished();
+    // the rest of the startup work waits for the window to be on screen
+    centralWidget()->installEventFilter(this);
 }
 
 MainWindow::~MainWindow()
@@ -158,6 +161,7 @@ void MainWindow::init()
     // setup view
     // ==================================================
     m_view->setVisible(false);
+    m_view->setLoadFromMemory(MangaReaderSettings::loadIntoMemory());
     connect(m_view, &View::addBookmark,
             this, &MainWindow::onAddBookmark);
     connect(m_view, &View::mouseMoved,
@@ -173,6 +177,7 @@ void MainWindow::init()
     connect(m_view, &View::imagesLoaded, this, [this]() {
         actionCollection()->action(u"focusView"_s)->trigger();
     });
+    connect(m_view, &View::imageShown, this, &MainWindow::firstPageShown, Qt::SingleShotConnection);
     centralWidgetLayout->addWidget(m_view);
 
     // ==================================================
@@ -183,7 +188,8 @@ void MainWindow::init()
     m_hamburgerMenu->hideActionsOf(toolBar());
     m_hamburgerMenu->setMenuBar(menuBar());
     m_hamburgerMenu->setMenuBarAdvertised(false);
-    connect(this, &MainWindow::constructorFinished, this, [this]() {
+    // built the first time it's opened
+    connect(m_hamburgerMenu, &KHamburgerMenu::aboutToShowMenu, this, [this]() {
         auto menu = new QMenu(this);
         menu->addAction(actionCollection()->action(u"openMangaArchive"_s));
         menu->addAction(actionCollection()->action(u"openMangaFolder"_s));
@@ -213,7 +219,7 @@ void MainWindow::init()
         menu->addAction(actionCollection()->action(u"file_quit"_s));
 
         m_hamburgerMenu->setMenu(menu);
-    });
+    }, Qt::SingleShotConnection);
 
     // ==================================================
     // setup dock widgets
@@ -237,16 +243,17 @@ void MainWindow::setupMangaTreeDockWidget()
     m_treeDock->setProperty("isEmpty", m_mangaTreeWidget->isEmpty());
 
     m_selectMangaLibraryComboBox = new QComboBox(treeDockWidget);
+    treeDockLayout->addWidget(m_selectMangaLibraryComboBox);
+    populateLibrarySelectionComboBox();
+    m_selectMangaLibraryComboBox->setCurrentText(mangaFolder);
+    // the library is scanned in finishStartup()
+    m_treeDock->setWindowTitle(m_selectMangaLibraryComboBox->currentText());
     connect(m_selectMangaLibraryComboBox, &QComboBox::currentTextChanged, this, [this](const QString &path) {
         m_mangaTreeWidget->setMangaFolder(path);
         m_treeDock->setWindowTitle(path);
         m_config->group(QString()).writeEntry("Manga Folder", path);
         m_config->sync();
     });
-    treeDockLayout->addWidget(m_selectMangaLibraryComboBox);
-    populateLibrarySelectionComboBox();
-    m_selectMangaLibraryComboBox->setCurrentText(mangaFolder);
-
 
     connect(m_mangaTreeWidget, &MangaTreeWidget::open, this, [this](QString path, bool resume, bool recursive) {
         if (!resume) {
@@ -405,16 +412,9 @@ void MainWindow::populateBookmarkModel()
         }
         QFileInfo pathInfo(path);
         QList<QStandardItem *> rowData;
-        QMimeDatabase db;
-        QMimeType type = db.mimeTypeForFile(pathInfo.absoluteFilePath());
-        QIcon icon = QIcon::fromTheme(u"folder"_s);
-        if (type.name().startsWith(u"application/"_s)) {
-            icon = QIcon::fromTheme(u"application-zip"_s);
-        }
         QString displayPrefix = (key.startsWith(RECURSIVE_KEY_PREFIX)) ? u"(r) "_s : QString();
 
         auto col1 = new QStandardItem(pathInfo.fileName().prepend(displayPrefix));
-        col1->setData(icon, Qt::DecorationRole);
         col1->setData(pathInfo.absoluteFilePath(), Qt::ToolTipRole);
         col1->setData(key, KeyRole);
         col1->setData(pathInfo.absoluteFilePath(), PathRole);
@@ -432,6 +432,65 @@ void MainWindow::populateBookmarkModel()
     }
     m_bookmarksDock->setVisible(m_bookmarksModel->rowCount() > 0);
     m_bookmarksDock->setProperty("isEmpty", !(m_bookmarksModel->rowCount() > 0));
+
+    if (m_startupFinished) {
+        decorateBookmarks();
+    }
+}
+
+void MainWindow::decorateBookmarks()
+{
+    // detecting the mime type can read the file, slow for many bookmarks on a cold disk
+    QMimeDatabase db;
+    for (int row = 0; row < m_bookmarksModel->rowCount(); ++row) {
+        QStandardItem *item = m_bookmarksModel->item(row, 0);
+        if (!item->data(Qt::DecorationRole).isNull()) {
+            continue;
+        }
+        QMimeType type = db.mimeTypeForFile(item->data(PathRole).toString());
+        QIcon icon = QIcon::fromTheme(u"folder"_s);
+        if (type.name().startsWith(u"application/"_s)) {
+            icon = QIcon::fromTheme(u"application-zip"_s);
+        }
+        item->setData(icon, Qt::DecorationRole);
+    }
+}
+
+bool MainWindow::eventFilter(QObject *object, QEvent *event)
+{
+    if (object == centralWidget() && event->type() == QEvent::Paint) {
+        centralWidget()->removeEventFilter(this);
+        Q_EMIT firstFrameShown();
+        // queued, so the frame gets finished first
+        QTimer::singleShot(0, this, &MainWindow::finishStartup);
+    }
+    return KXmlGuiWindow::eventFilter(object, event);
+}
+
+void MainWindow::finishStartup()
+{
+    TRACE_SCOPE("finishStartup", -1);
+
+    if (!m_selectMangaLibraryComboBox->currentText().isEmpty()) {
+        m_mangaTreeWidget->setMangaFolder(m_selectMangaLibraryComboBox->currentText());
+    }
+
+    decorateBookmarks();
+
+    // the previews of all the color schemes take a while to draw
+    auto *schemes = KColorSchemeManager::instance();
+    schemes->setAutosaveChanges(false);
+    KActionMenu *schemesMenu = KColorSchemeMenu::createMenu(schemes, this);
+    auto colorSchemeAction = qobject_cast<KActionMenu *>(actionCollection()->action(u"colorSchemeChooser"_s));
+    colorSchemeAction->setMenu(schemesMenu->menu());
+    connect(schemesMenu->menu(), &QMenu::triggered, this, [this](QAction *triggeredAction) {
+        KConfigGroup cg(m_config, u"UiSettings"_s);
+        cg.writeEntry("ColorScheme", KLocalizedString::removeAcceleratorMarker(triggeredAction->text()));
+        cg.sync();
+    });
+
+    m_startupFinished = true;
+    Q_EMIT startupFinished();
 }
 
 void MainWindow::openMangaArchive()
@@ -509,23 +568,21 @@ void MainWindow::loadImages(const QString &path, bool recursive)
 
 void MainWindow::setupActions()
 {
-    auto *schemes = KColorSchemeManager::instance();
-    schemes->setAutosaveChanges(false);
-
     KConfigGroup cg(m_config, u"UiSettings"_s);
     auto schemeName = cg.readEntry("ColorScheme", QString());
-    schemes->activateScheme(schemes->indexForScheme(schemeName));
+    // the default palette needs no scheme manager, otherwise the first frame
+    // has to be drawn with the chosen scheme already
+    if (!schemeName.isEmpty()) {
+        auto *schemes = KColorSchemeManager::instance();
+        schemes->setAutosaveChanges(false);
+        schemes->activateScheme(schemes->indexForScheme(schemeName));
+    }
 
-    auto colorSchemeAction = KColorSchemeMenu::createMenu(schemes, this);
+    // the menu is filled in finishStartup()
+    auto colorSchemeAction = new KActionMenu(QIcon::fromTheme(u"preferences-desktop-color"_s), i18n("Color Scheme"), this);
     colorSchemeAction->setPopupMode(QToolButton::InstantPopup);
     actionCollection()->addAction(u"colorSchemeChooser"_s, colorSchemeAction);
 
-    connect(colorSchemeAction->menu(), &QMenu::triggered, this, [this](QAction *triggeredAction) {
-        KConfigGroup cg(m_config, u"UiSettings"_s);
-        cg.writeEntry("ColorScheme", KLocalizedString::removeAcceleratorMarker(triggeredAction->text()));
-        cg.sync();
-    });
-
     auto focusMangaTree = new QAction();
     focusMangaTree->setText(i18n("Focus Manga Tree"));
     actionCollection()->addAction(u"focusTree"_s, focusMangaTree);
@@ -999,6 +1056,7 @@ void MainWindow::openSettings()
             m_config->group(QString()).deleteEntry("Manga Folder");
         }
         populateLibrarySelectionComboBox();
+        m_view->setLoadFromMemory(MangaReaderSettings::loadIntoMemory());
         if (m_view->isVisible()) {
             m_view->refreshPages();
         }
@@ -23,7 +23,6 @@ class QTableView;
 class View;
 class Worker;
 class QFileInfo;
-class QFileSystemModel;
 class SettingsWindow;
 
 using namespace Qt::StringLiterals;
@@ -53,7 +52,13 @@ public:
 
 Q_SIGNALS:
     void processArchiveRequested(const QString &path);
-    void constructorFinished();
+    /**
+     * Emitted when the window is first painted, the rest of the startup work
+     * (library scan, bookmark icons, color schemes) is done after it
+     */
+    void firstFrameShown();
+    void startupFinished();
+    void firstPageShown();
 
 private:
     static void showError(const QString &error);
@@ -80,6 +85,9 @@ private:
     auto isFullScreen() -> bool;
     void populateLibrarySelectionComboBox();
     void populateBookmarkModel();
+    void decorateBookmarks();
+    void finishStartup();
+    bool eventFilter(QObject *object, QEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *e) override;
     void dropEvent(QDropEvent *e) override;
 
@@ -99,6 +107,7 @@ private:
     QDialog            *m_renameDialog{nullptr};
     StartUpWidget      *m_startUpWidget{nullptr};
     int                 m_startPage{0};
+    bool                m_startupFinished{false};
     const QString       RECURSIVE_KEY_PREFIX{u":recursive:"_s};
     QStringList         m_supportedMimeTypes{u"application/zip"_s,
                                              u"application/x-cbz"_s,
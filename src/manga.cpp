@@ -5,54 +5,106 @@
  */
 
 #include "manga.h"
+#include "diskcache.h"
+#include "grayscale.h"
+#include "stallwatchdog.h"
+#include "trace.h"
 
+#include <QBuffer>
 #include <QCollator>
 #include <QDirIterator>
+#include <QFile>
 #include <QFileInfo>
 #include <QImageReader>
 #include <QMimeDatabase>
 #include <QThread>
-#include <QTimer>
+#include <QThreadPool>
 #include <QtConcurrent>
 
+// how much bigger than the requested size a decoded page is kept in the page cache
+static constexpr int MaxCachedScale{2};
+// previews are decoded at this fraction of the page size
+static constexpr int PreviewScale{8};
+
 Manga::Manga(const QString &path, QObject *parent)
     : QObject{parent}
     , m_path{path}
     , m_imageGenerationThread{new ImageGenerationThread(this)}
+    , m_compressedPageCache{std::make_shared<CompressedPageCache>()}
 {
+    m_pageCache.setEvictionHandler([cache = std::weak_ptr(m_compressedPageCache)](int pageNumber, const ImagePyramid &pyramid) {
+        // compressing takes a few milliseconds, don't block the decoding thread
+        QThreadPool::globalInstance()->start([cache, pageNumber, pyramid]() {
+            if (auto compressedPageCache = cache.lock()) {
+                compressedPageCache->insert(pageNumber, pyramid);
+            }
+        });
+    });
+
     QObject::connect(m_imageGenerationThread, &ImageGenerationThread::finished, this, [this] {
-        ImageRequest *request = m_imageGenerationThread->request();
+        ImageRequest *request = m_executingRequest.get();
         const QImage &img = request->image;
-        Q_EMIT imageReady(img, request->pageNumber);
+        if (request->finishedAt >= 0) {
+            // from the worker finishing to this queued slot running
+            Trace::addSpan("queued", request->finishedAt, Trace::now(), request->pageNumber, true);
+        }
+        m_busyTime += request->decodeTime;
+        if (!request->preview && request->tile < 0) {
+            // moving average, cache hits count too since they are part of the throughput
+            m_averageDecodeTime += (request->decodeTime - m_averageDecodeTime) * 0.2;
+        }
+        if (request->emitSignals) {
+            if (request->tile >= 0) {
+                Q_EMIT tileReady(img, request->pageNumber, request->tile);
+            } else if (request->preview) {
+                Q_EMIT previewReady(img, request->pageNumber);
+            } else {
+                Q_EMIT imageReady(img, request->pageNumber);
+            }
+        }
+        if (!request->promise.isCanceled()) {
+            request->promise.addResult(PageImage(request->pageNumber, std::move(request->image)));
+        }
+        request->promise.finish();
+        if (request->queuedAt >= 0) {
+            Trace::addSpan("request", request->queuedAt, Trace::now(), request->pageNumber, true);
+        }
 
         m_imageGenerationThread->endGeneration();
         m_canGenerate = true;
 
-        requestDone(request);
+        requestDone();
     }, Qt::QueuedConnection);
 
     connect(&m_extractor, &Extractor::finishedRar, this, [this]() {
+        STALL_SCOPE("Manga::finishedRar");
         m_extractionFolder = m_extractor.extractionFolder();
         m_openFolderRecursive = true;
         QMimeDatabase db;
         m_mimeType = db.mimeTypeForFile(m_path, QMimeDatabase::MatchContent);
-        getFolderImages();
+        {
+            STALL_SCOPE("Manga::getFolderImages");
+            getFolderImages();
+        }
         if (!m_images.isEmpty()) {
             Q_EMIT imagesReady();
         }
+        preloadFolderImages();
     });
 
     connect(&m_extractor, &Extractor::progress,
             this, &Manga::extractionProgress);
+
+    m_extractor.setStopToken(m_stopSource.get_token());
 }
 
 Manga::~Manga()
 {
-    m_imageRequestsMutex.lock();
-    qDeleteAll(m_imageRequestsStack);
-    m_imageRequestsStack.clear();
-
-    m_imageRequestsMutex.unlock();
+    STALL_SCOPE("Manga::~Manga");
+    cancelArchiveProcessing();
+    m_processArchiveFuture.waitForFinished();
+    m_preloadFuture.cancel();
+    m_preloadFuture.waitForFinished();
 
     if (m_imageGenerationThread) {
         m_imageGenerationThread->wait();
@@ -62,6 +114,7 @@ Manga::~Manga()
 
 void Manga::init()
 {
+    STALL_SCOPE("Manga::init");
     QFileInfo fi{m_path};
     QMimeDatabase db;
     m_mimeType = db.mimeTypeForFile(m_path, QMimeDatabase::MatchContent);
@@ -79,26 +132,51 @@ void Manga::init()
         m_type = Type::Unknown;
     }
 
+    if (m_type != Type::Folder && m_type != Type::Unknown) {
+        m_archiveFingerprint = DiskCache::fingerprint(m_path);
+    }
+
     switch(m_type) {
     case Type::FileCbz:
     case Type::FileCb7:
     case Type::FileCbt:
         m_processArchiveFuture = QtConcurrent::run([this]() {
-            m_extractor.open(m_path);
-            m_images = m_extractor.filesList();
+            {
+                TRACE_SCOPE("open", -1);
+                m_extractor.open(m_path);
+            }
+            QList<Image> images;
+            {
+                TRACE_SCOPE("index", -1);
+                images = m_extractor.filesList();
+            }
+            {
+                // requestPage() reads them from other threads
+                QMutexLocker locker(&m_imageRequestsMutex);
+                m_images = std::move(images);
+            }
+            if (m_stopSource.stop_requested()) {
+                return;
+            }
             QMetaObject::invokeMethod(this, [this]() {
                 Q_EMIT imagesReady();
             }, Qt::QueuedConnection);
         });
         break;
-    case Type::FileCbr:
+    case Type::FileCbr: {
+        TRACE_SCOPE("open", -1);
         m_extractor.open(m_path);
         break;
+    }
     case Type::Folder:
-        getFolderImages();
+        {
+            STALL_SCOPE("Manga::getFolderImages");
+            getFolderImages();
+        }
         if (!m_images.isEmpty()) {
             Q_EMIT imagesReady();
         }
+        preloadFolderImages();
         break;
     case Type::Unknown:
         qDebug() << "Unknown manga type";
@@ -113,23 +191,269 @@ Manga::Type Manga::type() const
 
 QImage Manga::image(ImageRequest *request)
 {
-    QImage img;
+    if (request->tile >= 0) {
+        return decodeTile(request);
+    }
+
+    const auto scaled = [request](const ImagePyramid &pyramid) {
+        TRACE_SCOPE("scale", request->pageNumber);
+        return pyramid.scaled(request->size);
+    };
+
+    ImagePyramid pyramid = m_pageCache.find(request->pageNumber);
+    bool fromCompressedCache{false};
+    if (pyramid.isNull()) {
+        pyramid = m_compressedPageCache->take(request->pageNumber);
+        if (!pyramid.isNull()) {
+            fromCompressedCache = true;
+            m_pageCache.insert(request->pageNumber, pyramid);
+        }
+    }
+    if (pyramid.isNull() && m_useDiskCache) {
+        // exact size match from an earlier session, no extraction or decode needed
+        QImage cached = findInDiskCache(request);
+        if (!cached.isNull()) {
+            ++m_diskCacheHits;
+            request->preview = false;
+            m_pageCache.insert(request->pageNumber, ImagePyramid(cached, false));
+            return cached;
+        }
+    }
+
+    if (request->preview) {
+        // the full page is already decoded, no point in showing a preview
+        if (pyramid.canServe(request->size)) {
+            request->preview = false;
+            return scaled(pyramid);
+        }
+        return decodePreview(request);
+    }
+
+    if (!pyramid.canServe(request->size)) {
+        ++m_cacheMisses;
+        QImage img = decode(request);
+        if (img.isNull()) {
+            return img;
+        }
+
+        // keep a bit more than what was asked so zooming in doesn't need a new decode,
+        // but don't hold on to huge source images
+        const QSize maxSize = request->size * MaxCachedScale;
+        const bool fullResolution = img.width() <= maxSize.width() && img.height() <= maxSize.height();
+        if (!fullResolution) {
+            TRACE_SCOPE("scale", request->pageNumber);
+            img = Grayscale::scaled(img, maxSize, Qt::KeepAspectRatio);
+        }
+        {
+            TRACE_SCOPE("pyramid", request->pageNumber);
+            pyramid = ImagePyramid(img, fullResolution);
+        }
+        m_pageCache.insert(request->pageNumber, pyramid);
+
+        QImage image = scaled(pyramid);
+        if (m_useDiskCache) {
+            storeInDiskCache(request, image);
+        }
+        return image;
+    }
+
+    if (fromCompressedCache) {
+        ++m_compressedCacheHits;
+    } else {
+        ++m_pageCacheHits;
+    }
+    return scaled(pyramid);
+}
+
+QImage Manga::findInDiskCache(const ImageRequest *request)
+{
+    const QByteArray key = fingerprint(request);
+    const QString entry = entryName(request);
+    for (const auto format : {QImage::Format_Grayscale8, QImage::Format_RGB32, QImage::Format_ARGB32_Premultiplied}) {
+        QImage img = DiskCache::self()->find(key, entry, request->size, format);
+        if (!img.isNull()) {
+            return img;
+        }
+    }
+    return {};
+}
+
+void Manga::storeInDiskCache(const ImageRequest *request, const QImage &image)
+{
+    // pages are stored in the formats that are fastest to paint, black and white pages stay 8 bit
+    QImage::Format format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    if (image.format() == QImage::Format_Grayscale8) {
+        format = QImage::Format_Grayscale8;
+    }
+    const QImage img = image.convertToFormat(format);
+    const QByteArray key = fingerprint(request);
+    const QString entry = entryName(request);
+    // writing is not on the way of showing the page
+    QThreadPool::globalInstance()->start([key, entry, img]() {
+        DiskCache::self()->insert(key, entry, img);
+    });
+}
+
+QByteArray Manga::fingerprint(const ImageRequest *request) const
+{
+    if (m_type == Type::Folder) {
+        return DiskCache::fingerprint(request->path);
+    }
+    return m_archiveFingerprint;
+}
+
+QString Manga::entryName(const ImageRequest *request) const
+{
+    switch (m_type) {
+    case Type::FileCbr:
+        // rar archives are extracted to a new temporary folder each time,
+        // `unrar e` leaves out the subfolders so the file name is all that's kept
+        return QFileInfo(request->path).fileName();
+    case Type::Folder:
+        return QString();
+    default:
+        return request->path;
+    }
+}
+
+QImage Manga::decode(const ImageRequest *request)
+{
+    QByteArray data;
     switch(m_type) {
     case Type::FileCbz:
     case Type::FileCb7:
     case Type::FileCbt:
-        m_extractor.open(m_path);
-        img.loadFromData(m_extractor.getFileData(request->path));
+        data = archiveFileData(request);
+        // the full decode is the last one to need it
+        if (m_pageSourcePath == request->path) {
+            m_pageSourcePath.clear();
+            m_pageSourceData.clear();
+        }
         break;
     case Type::FileCbr:
     case Type::Folder:
-        img.load(request->path);
+        data = preloadedData(request->path);
         break;
     case Type::Unknown:
         break;
     }
 
-    return img.scaled(request->size.width(), request->size.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    QImage img;
+    {
+        // files not preloaded are read as part of the decode
+        TRACE_SCOPE("decode", request->pageNumber);
+        if (data.isEmpty() && (m_type == Type::FileCbr || m_type == Type::Folder)) {
+            img.load(request->path);
+        } else {
+            img.loadFromData(data);
+        }
+    }
+
+    // black and white pages are kept as 8 bit through all caches,
+    // they are expanded only when uploaded to a pixmap
+    return Grayscale::convertIfGrayscale(img);
+}
+
+bool Manga::openReader(const ImageRequest *request, QImageReader &reader, QBuffer &buffer, QFile &file)
+{
+    switch(m_type) {
+    case Type::FileCbz:
+    case Type::FileCb7:
+    case Type::FileCbt:
+        if (request->tile >= 0) {
+            m_tileSourceData = archiveFileData(request);
+            m_tileSourcePath = request->path;
+            buffer.setData(m_tileSourceData);
+        } else {
+            // a preview, kept for the full decode that follows it
+            m_pageSourceData = archiveFileData(request);
+            m_pageSourcePath = request->path;
+            buffer.setData(m_pageSourceData);
+        }
+        buffer.open(QIODevice::ReadOnly);
+        reader.setDevice(&buffer);
+        return true;
+    case Type::FileCbr:
+    case Type::Folder:
+        if (const QByteArray data = preloadedData(request->path); !data.isEmpty()) {
+            buffer.setData(data);
+            buffer.open(QIODevice::ReadOnly);
+            reader.setDevice(&buffer);
+            return true;
+        }
+        file.setFileName(request->path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        reader.setDevice(&file);
+        return true;
+    case Type::Unknown:
+        break;
+    }
+    return false;
+}
+
+QByteArray Manga::archiveFileData(const ImageRequest *request)
+{
+    if (m_pageSourcePath == request->path) {
+        return m_pageSourceData;
+    }
+    if (m_tileSourcePath == request->path) {
+        return m_tileSourceData;
+    }
+    TRACE_SCOPE("getFileData", request->pageNumber);
+    m_extractor.open(m_path);
+    return m_extractor.getFileData(request->path);
+}
+
+QImage Manga::decodeTile(const ImageRequest *request)
+{
+    QBuffer buffer;
+    QFile file;
+    QImageReader reader;
+    if (!openReader(request, reader, buffer, file)) {
+        return {};
+    }
+
+    // only the rows of the tile are decoded,
+    // the whole page would not fit in memory or within Qt's allocation limit
+    reader.setClipRect(request->sourceRect);
+    reader.setScaledSize(request->size);
+    TRACE_SCOPE("decodeTile", request->pageNumber);
+    QImage img = reader.read();
+    if (img.isNull()) {
+        qDebug() << "Could not decode tile" << request->tile << "of" << request->path << reader.errorString();
+    }
+    return img;
+}
+
+QImage Manga::decodePreview(const ImageRequest *request)
+{
+    ImagePyramid preview = m_previewCache.find(request->pageNumber);
+    if (!preview.isNull()) {
+        return preview.base();
+    }
+
+    QBuffer buffer;
+    QFile file;
+    QImageReader reader;
+    if (!openReader(request, reader, buffer, file)) {
+        return {};
+    }
+
+    // with a scaled size set the jpeg handler decodes at 1/8 DCT scale,
+    // other formats are decoded as usual and scaled down fast
+    const QSize previewSize = (request->size / PreviewScale).expandedTo({1, 1});
+    reader.setScaledSize(previewSize);
+    reader.setQuality(0);
+    TRACE_SCOPE("decodePreview", request->pageNumber);
+    QImage img = reader.read();
+    if (img.isNull()) {
+        return img;
+    }
+
+    m_previewCache.insert(request->pageNumber, ImagePyramid(img, false));
+    return img;
 }
 
 QList<Image> Manga::images() const
@@ -137,66 +461,76 @@ QList<Image> Manga::images() const
     return m_images;
 }
 
-void Manga::addRequests(QList<ImageRequest *> requests)
+QImage Manga::cachedImage(int pageNumber)
 {
-    QSet<int> requestedPages;
-    {
-        for (const ImageRequest *request : requests) {
-            requestedPages.insert(request->pageNumber);
-        }
+    ImagePyramid pyramid = m_pageCache.find(pageNumber);
+    if (pyramid.isNull()) {
+        pyramid = m_compressedPageCache->take(pageNumber);
+        m_pageCache.insert(pageNumber, pyramid);
     }
+    return pyramid.isNull() ? QImage{} : pyramid.base();
+}
 
-    m_imageRequestsMutex.lock();
-    auto sIt = m_imageRequestsStack.begin();
-    auto sEnd = m_imageRequestsStack.end();
-    // Iterate through the pending request stack and remove any requests that
-    // target pages already present in the new request set. This prevents
-    // duplicate work and ensures that only the most recent request for a page
-    // remains in the queue.
-    while (sIt != sEnd) {
-        if (requestedPages.contains((*sIt)->pageNumber)) {
-            delete *sIt;
-            sIt = m_imageRequestsStack.erase(sIt);
-        } else {
-            ++sIt;
-        }
+void Manga::addRequests(std::vector<std::unique_ptr<ImageRequest>> requests)
+{
+    const qint64 queuedAt = Trace::isEnabled() ? Trace::now() : -1;
+    for (auto &request : requests) {
+        request->queuedAt = queuedAt;
+        request->promise.start();
     }
 
-    for (ImageRequest *request : requests) {
-        m_imageRequestsStack.push_back(request);
+    {
+        QMutexLocker locker(&m_imageRequestsMutex);
+        m_scheduler->addReplacing(std::move(requests));
     }
-    m_imageRequestsMutex.unlock();
 
     sendRequest();
 }
 
-void Manga::sendRequest()
+QFuture<PageImage> Manga::requestPage(int index, const QSize &size, int priority)
 {
-    ImageRequest *request = nullptr;
-    m_imageRequestsMutex.lock();
-    while (!m_imageRequestsStack.empty() && !request) {
-        ImageRequest *r = m_imageRequestsStack.back();
-        if (!r) {
-            m_imageRequestsStack.pop_back();
-            continue;
+    auto request = std::make_unique<ImageRequest>();
+    request->pageNumber = index;
+    request->size = size;
+    request->priority = priority;
+
+    QFuture<PageImage> future = request->promise.future();
+    request->promise.start();
+
+    {
+        QMutexLocker locker(&m_imageRequestsMutex);
+        if (index < 0 || index >= m_images.size()) {
+            // finished without a result
+            request->promise.finish();
+            return future;
         }
-        request = r;
+        request->path = m_images.at(index).path;
+        if (Trace::isEnabled()) {
+            request->queuedAt = Trace::now();
+        }
+        m_scheduler->add(std::move(request));
     }
-    if (!request) {
-        m_imageRequestsMutex.unlock();
+
+    // the generation thread is driven from the thread this object lives in
+    QMetaObject::invokeMethod(this, &Manga::sendRequest, Qt::AutoConnection);
+    return future;
+}
+
+void Manga::sendRequest()
+{
+    if (!canGeneratePixmap()) {
+        // the running request calls this again when it's done
         return;
     }
 
-    if (canGeneratePixmap()) {
-        m_imageRequestsStack.remove(request);
-        m_executingImageRequests.push_back(request);
-        m_imageRequestsMutex.unlock();
-
-        generatePixmap(request);
-    } else {
-        m_imageRequestsMutex.unlock();
-        QTimer::singleShot(30, this, [this] { sendRequest(); });
+    QMutexLocker locker(&m_imageRequestsMutex);
+    m_executingRequest = m_scheduler->takeNext();
+    locker.unlock();
+    if (!m_executingRequest) {
+        return;
     }
+
+    generatePixmap(m_executingRequest.get());
 }
 
 void Manga::generatePixmap(ImageRequest *request)
@@ -205,21 +539,12 @@ void Manga::generatePixmap(ImageRequest *request)
     m_imageGenerationThread->startGeneration(request);
 }
 
-void Manga::requestDone(ImageRequest *request)
+void Manga::requestDone()
 {
-    if (!request) {
-        return;
-    }
+    m_executingRequest.reset();
 
     m_imageRequestsMutex.lock();
-    m_executingImageRequests.remove(request);
-    m_imageRequestsMutex.unlock();
-
-    delete request;
-    request = nullptr;
-
-    m_imageRequestsMutex.lock();
-    bool hasPixmaps = !m_imageRequestsStack.empty();
+    bool hasPixmaps = !m_scheduler->isEmpty();
     m_imageRequestsMutex.unlock();
     if (hasPixmaps) {
         sendRequest();
@@ -267,6 +592,7 @@ bool Manga::isFolder()
 
 QList<Image> Manga::getFolderImages()
 {
+    TRACE_SCOPE("index", -1);
     // get images from path
     QDirIterator::IteratorFlags flags = m_openFolderRecursive
         ? QDirIterator::Subdirectories
@@ -275,6 +601,7 @@ QList<Image> Manga::getFolderImages()
     QMimeDatabase db;
 
     auto path = m_extractionFolder.isEmpty() ? m_path : m_extractionFolder;
+    QList<Image> images;
     QDirIterator it(path, QDir::Files, flags);
     while (it.hasNext()) {
         QString file = it.next();
@@ -282,22 +609,61 @@ QList<Image> Manga::getFolderImages()
         // only get images
         if (db.mimeTypeForFile(file).name().startsWith(u"image/"_s)) {
             QImageReader reader(file);
-            m_images.append({file, reader.size()});
+            images.append({file, reader.size()});
         }
     }
     // natural sort images
     QCollator collator;
     collator.setNumericMode(true);
-    std::sort(m_images.begin(), m_images.end(), [&collator](const Image &a, const Image &b) {
+    std::sort(images.begin(), images.end(), [&collator](const Image &a, const Image &b) {
         return collator.compare(a.path, b.path) < 0;
     });
 
-    if (m_images.isEmpty()) {
-        return {};
-    }
+    // requestPage() reads them from other threads
+    QMutexLocker locker(&m_imageRequestsMutex);
+    m_images.append(images);
     return m_images;
 }
 
+void Manga::preloadFolderImages()
+{
+    if (!m_loadIntoMemory || m_images.isEmpty()) {
+        return;
+    }
+
+    QStringList paths;
+    qint64 totalSize{0};
+    for (const Image &image : std::as_const(m_images)) {
+        totalSize += QFileInfo(image.path).size();
+        paths.append(image.path);
+    }
+    if (totalSize > m_maxInMemorySize) {
+        return;
+    }
+
+    // read in page order, pages not read yet are loaded from disk as usual
+    m_preloadFuture = QtConcurrent::run([this, paths](QPromise<void> &promise) {
+        for (const QString &path : paths) {
+            if (promise.isCanceled()) {
+                return;
+            }
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                continue;
+            }
+            const QByteArray data = file.readAll();
+            QMutexLocker locker(&m_preloadedDataMutex);
+            m_preloadedData.insert(path, data);
+        }
+    });
+}
+
+QByteArray Manga::preloadedData(const QString &path)
+{
+    QMutexLocker locker(&m_preloadedDataMutex);
+    return m_preloadedData.value(path);
+}
+
 bool Manga::openFolderRecursive() const
 {
     return m_openFolderRecursive;
@@ -308,10 +674,103 @@ void Manga::setOpenFolderRecursive(bool newOpenFolderRecursive)
     m_openFolderRecursive = newOpenFolderRecursive;
 }
 
-void Manga::cancelArchiveProcessing()
+void Manga::setPageCacheSize(qint64 bytes)
+{
+    m_pageCache.setMaxCost(bytes);
+}
+
+void Manga::setCompressedPageCacheSize(qint64 bytes)
+{
+    m_compressedPageCache->setMaxCost(bytes);
+}
+
+void Manga::setDiskCacheEnabled(bool enabled)
+{
+    m_useDiskCache = enabled;
+}
+
+qreal Manga::averageDecodeTime() const
+{
+    return m_averageDecodeTime;
+}
+
+void Manga::setSchedulingPolicy(RequestScheduler::Policy policy)
+{
+    QMutexLocker locker(&m_imageRequestsMutex);
+    std::unique_ptr<RequestScheduler> scheduler = RequestScheduler::create(policy);
+    // pending requests carry over
+    for (auto &request : m_scheduler->takeAll()) {
+        scheduler->add(std::move(request));
+    }
+    m_scheduler = std::move(scheduler);
+}
+
+void Manga::setScrollState(const RequestScheduler::ScrollState &state)
+{
+    QMutexLocker locker(&m_imageRequestsMutex);
+    m_scheduler->setScrollState(state);
+}
+
+bool Manga::usesScrollState()
+{
+    QMutexLocker locker(&m_imageRequestsMutex);
+    return m_scheduler->usesScrollState();
+}
+
+Manga::Statistics Manga::statistics()
 {
-    if (m_processArchiveFuture.isRunning()) {
-        m_processArchiveFuture.cancel();
-        m_processArchiveFuture.waitForFinished();
+    Statistics statistics;
+    {
+        QMutexLocker locker(&m_imageRequestsMutex);
+        statistics.pendingRequests = static_cast<int>(m_scheduler->size());
     }
+    statistics.executing = m_executingRequest != nullptr;
+    statistics.busyTime = m_busyTime;
+    statistics.pageCacheHits = m_pageCacheHits;
+    statistics.compressedCacheHits = m_compressedCacheHits;
+    statistics.diskCacheHits = m_diskCacheHits;
+    statistics.cacheMisses = m_cacheMisses;
+    return statistics;
+}
+
+void Manga::setLoadIntoMemory(bool enabled, qint64 maxSize)
+{
+    m_loadIntoMemory = enabled;
+    m_maxInMemorySize = maxSize;
+    m_extractor.setLoadIntoMemory(enabled, maxSize);
+}
+
+void Manga::setUnrarPath(const QString &path)
+{
+    m_extractor.setUnrarPath(path);
+}
+
+void Manga::cancelArchiveProcessing()
+{
+    STALL_SCOPE("Manga::cancelArchiveProcessing");
+    // the running open and listing check the stop token and return early,
+    // nothing here waits for them
+    m_stopSource.request_stop();
+    m_extractor.abortRar();
+    m_preloadFuture.cancel();
+
+    QMutexLocker locker(&m_imageRequestsMutex);
+    m_scheduler->clear();
+}
+
+void Manga::abandon()
+{
+    cancelArchiveProcessing();
+
+    // wait for the workers on the thread pool instead of the gui thread
+    QFuture<void> finished = QtConcurrent::run([processArchiveFuture = m_processArchiveFuture,
+                                                preloadFuture = m_preloadFuture,
+                                                thread = m_imageGenerationThread]() mutable {
+        processArchiveFuture.waitForFinished();
+        preloadFuture.waitForFinished();
+        thread->wait();
+    });
+    finished.then(this, [this]() {
+        deleteLater();
+    });
 }
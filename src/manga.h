@@ -16,6 +16,18 @@
 #include "image.h"
 #include "imagegenerationthread.h"
 #include "imagerequest.h"
+#include "compressedpagecache.h"
+#include "pageimage.h"
+#include "pagecache.h"
+#include "requestscheduler.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QBuffer;
+class QFile;
+class QImageReader;
 
 using namespace Qt::StringLiterals;
 
@@ -26,6 +38,19 @@ public:
     explicit Manga(const QString &path, QObject *parent = nullptr);
     ~Manga();
 
+    struct Statistics {
+        int pendingRequests{0};
+        bool executing{false};
+        // milliseconds the worker spent producing images
+        qint64 busyTime{0};
+        // full pages served from the page cache, the compressed cache and the disk cache
+        quint64 pageCacheHits{0};
+        quint64 compressedCacheHits{0};
+        quint64 diskCacheHits{0};
+        // full pages that had to be extracted and decoded
+        quint64 cacheMisses{0};
+    };
+
     enum class Type {
         Unknown,
         FileCbz,
@@ -39,28 +64,104 @@ public:
     Type type() const;
     QImage image(ImageRequest *request);
     QList<Image> images() const;
-    void addRequests(QList<ImageRequest *> requests);
+    /**
+     * The largest decoded version of the page, if it's still in the page cache
+     */
+    QImage cachedImage(int pageNumber);
+    /**
+     * Queues requests whose results are broadcast through the signals,
+     * pending requests for the same pages are replaced
+     */
+    void addRequests(std::vector<std::unique_ptr<ImageRequest>> requests);
+    /**
+     * Decodes page `index` scaled to `size`. Higher `priority` requests are
+     * decoded first. Cancelling the future drops the request if it hasn't started.
+     * Can be called from any thread.
+     */
+    QFuture<PageImage> requestPage(int index, const QSize &size, int priority = 0);
+    /**
+     * How pending requests of the same priority are ordered,
+     * RequestScheduler::defaultPolicy() until changed
+     */
+    void setSchedulingPolicy(RequestScheduler::Policy policy);
+    /**
+     * Where the reader is and how fast they scroll, for the policies that use it
+     */
+    void setScrollState(const RequestScheduler::ScrollState &state);
+    bool usesScrollState();
+    /**
+     * Stops opening the manga and deletes this object once the background
+     * work has finished, without blocking the caller
+     */
+    void abandon();
+    /**
+     * Moving average of the time, in milliseconds, it takes to produce a page
+     */
+    qreal averageDecodeTime() const;
+    /**
+     * Counters since the manga was opened, for the performance overlay
+     */
+    Statistics statistics();
     void cancelArchiveProcessing();
 
     bool openFolderRecursive() const;
     void setOpenFolderRecursive(bool newOpenFolderRecursive);
 
+    /**
+     * Memory budget, in bytes, for decoded pages kept around
+     * to serve zoom and resize requests without decoding again
+     */
+    void setPageCacheSize(qint64 bytes);
+    /**
+     * Memory budget, in bytes, for pages evicted from the page cache and kept compressed
+     */
+    void setCompressedPageCacheSize(qint64 bytes);
+    /**
+     * Look for pages in, and store scaled pages to, the persistent disk cache
+     */
+    void setDiskCacheEnabled(bool enabled);
+    /**
+     * Read archives and folders up to `maxSize` bytes into memory when opened,
+     * pages are then served without touching the disk
+     */
+    void setLoadIntoMemory(bool enabled, qint64 maxSize);
+    /**
+     * Path of the unrar executable used to open rar archives
+     */
+    void setUnrarPath(const QString &path);
+
 Q_SIGNALS:
     void imagesReady();
     void imageReady(const QImage &image, int number);
+    void tileReady(const QImage &image, int number, int tile);
+    void previewReady(const QImage &image, int number);
     void extractionProgress(int);
 
 private:
     void sendRequest();
     void generatePixmap(ImageRequest *request);
-    void requestDone(ImageRequest *request);
+    void requestDone();
     bool canGeneratePixmap();
+    QImage decode(const ImageRequest *request);
+    QImage decodeTile(const ImageRequest *request);
+    QImage decodePreview(const ImageRequest *request);
+    QImage findInDiskCache(const ImageRequest *request);
+    void storeInDiskCache(const ImageRequest *request, const QImage &image);
+    QByteArray fingerprint(const ImageRequest *request) const;
+    QString entryName(const ImageRequest *request) const;
+    bool openReader(const ImageRequest *request, QImageReader &reader, QBuffer &buffer, QFile &file);
+    /**
+     * Encoded data of the page from the archive, reusing what a preview or tile read already
+     */
+    QByteArray archiveFileData(const ImageRequest *request);
     bool isZip();
     bool isRar();
     bool isTar();
     bool is7Z();
     bool isFolder();
     QList<Image> getFolderImages();
+    void preloadFolderImages();
+    QByteArray preloadedData(const QString &path);
 
     QString m_path;
     QString m_extractionFolder;
@@ -69,12 +170,39 @@ private:
     QList<Image> m_images;
     Extractor m_extractor;
     bool m_canGenerate{true};
-    std::list<ImageRequest *> m_imageRequestsStack;
-    std::list<ImageRequest *> m_executingImageRequests;
+    std::unique_ptr<RequestScheduler> m_scheduler{RequestScheduler::create(RequestScheduler::defaultPolicy())};
+    std::unique_ptr<ImageRequest> m_executingRequest;
     QMutex m_imageRequestsMutex;
     ImageGenerationThread *m_imageGenerationThread{nullptr};
     QFuture<void> m_processArchiveFuture;
+    std::stop_source m_stopSource;
     bool m_openFolderRecursive{false};
+    PageCache m_pageCache;
+    // shared with the workers compressing evicted pages, which can outlive this object
+    std::shared_ptr<CompressedPageCache> m_compressedPageCache;
+    bool m_useDiskCache{false};
+    QByteArray m_archiveFingerprint;
+    // previews have their own budget so they are never evicted to make room for full pages
+    PageCache m_previewCache{32 * 1024 * 1024};
+    // encoded data of the last tiled page, so its tiles don't extract it over and over
+    QString m_tileSourcePath;
+    QByteArray m_tileSourceData;
+    // encoded data of the last page shown as a preview, its full decode comes next
+    QString m_pageSourcePath;
+    QByteArray m_pageSourceData;
+    qreal m_averageDecodeTime{0};
+    qint64 m_busyTime{0};
+    // updated by the image generation thread
+    std::atomic<quint64> m_pageCacheHits{0};
+    std::atomic<quint64> m_compressedCacheHits{0};
+    std::atomic<quint64> m_diskCacheHits{0};
+    std::atomic<quint64> m_cacheMisses{0};
+    bool m_loadIntoMemory{false};
+    qint64 m_maxInMemorySize{0};
+    // encoded images of folders (and extracted rar archives) read into memory
+    QHash<QString, QByteArray> m_preloadedData;
+    QMutex m_preloadedDataMutex;
+    QFuture<void> m_preloadFuture;
 
     const QStringList m_supportedMimeTypes{u"application/zip"_s,
                                            u"application/x-cbz"_s,
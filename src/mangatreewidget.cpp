@@ -6,13 +6,16 @@
 
 #include "mangatreewidget.h"
 
-#include <QFileSystemModel>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLineEdit>
+#include <QListView>
 #include <QMenu>
 #include <QSortFilterProxyModel>
+#include <QTimer>
+#include <QToolButton>
 #include <QTreeView>
+#include <QtConcurrent>
 #include <settings.h>
 
 #include <KFileItem>
@@ -22,33 +25,68 @@
 #include <KIO/RenameFileDialog>
 #include <KLocalizedString>
 
+#include "coverloader.h"
+#include "librarymodel.h"
+
 using namespace Qt::StringLiterals;
 
+static constexpr int GridIconSize{128};
+
 MangaTreeWidget::MangaTreeWidget()
     : m_treeView{ new QTreeView() }
-    , m_treeModel{ new QFileSystemModel() }
+    , m_gridView{ new QListView() }
+    , m_treeModel{ new LibraryModel(this) }
+    , m_coverLoader{ new CoverLoader(this) }
     , m_isEmpty{ MangaReaderSettings::mangaFolders().isEmpty() }
 {
     m_treeModel->setObjectName("mangaTree");
-    m_treeModel->setFilter(QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot);
-    m_treeModel->setNameFilters(QStringList() << u"*.zip"_s << u"*.cbz"_s
-                                              << u"*.rar"_s << u"*.cbr"_s
-                                              << u"*.7z"_s  << u"*.cb7"_s
-                                              << u"*.tar"_s << u"*.cbt"_s);
-    m_treeModel->setNameFilterDisables(false);
-
-    m_treeProxyModel = new FSProxyModel();
+
+    // a matching folder shows all of its content
+    m_treeProxyModel = new LibraryProxyModel(this);
     m_treeProxyModel->setSourceModel(m_treeModel);
     m_treeProxyModel->setRecursiveFilteringEnabled(true);
-    m_treeProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    m_treeProxyModel->setFilterKeyColumn(0);
+    m_treeProxyModel->setAutoAcceptChildRows(true);
+
+    // the search index is rebuilt once the library stops changing
+    m_searchBuildTimer = new QTimer(this);
+    m_searchBuildTimer->setSingleShot(true);
+    m_searchBuildTimer->setInterval(1000);
+    connect(m_searchBuildTimer, &QTimer::timeout, this, [this]() {
+        startSearchBuild(false);
+    });
+    connect(m_treeModel, &LibraryModel::indexChanged, m_searchBuildTimer, qOverload<>(&QTimer::start));
+    connect(MangaReaderSettings::self(), &MangaReaderSettings::SearchArchiveContentsChanged, this, [this]() {
+        if (MangaReaderSettings::searchArchiveContents()) {
+            startSearchBuild(true);
+        }
+    });
+
+    auto setUnrarPath = [this]() {
+        m_coverLoader->setUnrarPath(MangaReaderSettings::unrarPath().isEmpty() ? MangaReaderSettings::autoUnrarPath()
+                                                                               : MangaReaderSettings::unrarPath());
+    };
+    setUnrarPath();
+    connect(MangaReaderSettings::self(), &MangaReaderSettings::UnrarPathChanged, this, setUnrarPath);
+    connect(MangaReaderSettings::self(), &MangaReaderSettings::ShowCoversChanged, this, &MangaTreeWidget::updateCovers);
 
     m_treeView->setModel(m_treeProxyModel);
-    m_treeView->setColumnHidden(1, true);
-    m_treeView->setColumnHidden(2, true);
-    m_treeView->setColumnHidden(3, true);
     m_treeView->header()->hide();
     m_treeView->setContextMenuPolicy(Qt::CustomContextMenu);
+    // row heights are not asked for every row of a big library
+    m_treeView->setUniformRowHeights(true);
+
+    // one folder at a time, series folders are browsed into
+    m_gridView->setModel(m_treeProxyModel);
+    m_gridView->setViewMode(QListView::IconMode);
+    m_gridView->setResizeMode(QListView::Adjust);
+    m_gridView->setMovement(QListView::Static);
+    m_gridView->setIconSize(QSize(GridIconSize, GridIconSize));
+    m_gridView->setGridSize(QSize(GridIconSize + 32, GridIconSize + 2 * fontMetrics().height() + 16));
+    m_gridView->setWordWrap(true);
+    m_gridView->setTextElideMode(Qt::ElideMiddle);
+    // otherwise every item is measured, which asks for all their covers
+    m_gridView->setUniformItemSizes(true);
+    m_gridView->setContextMenuPolicy(Qt::CustomContextMenu);
 
     auto action = new QAction(this);
     action->setShortcuts({Qt::Key_Enter, Qt::Key_Return});
@@ -77,30 +115,72 @@ MangaTreeWidget::MangaTreeWidget()
         Q_EMIT open(path, resume, recursive);
     });
 
-    connect(m_treeView, &QTreeView::customContextMenuRequested,
-            this, &MangaTreeWidget::treeViewContextMenu);
+    connect(m_treeView, &QTreeView::customContextMenuRequested, this, [this](QPoint point) {
+        treeViewContextMenu(m_treeView, point);
+    });
+
+    auto openGridItemAction = new QAction(this);
+    openGridItemAction->setShortcuts({Qt::Key_Enter, Qt::Key_Return});
+    openGridItemAction->setShortcutContext(Qt::WidgetShortcut);
+    connect(openGridItemAction, &QAction::triggered, this, [this]() {
+        openGridItem(m_gridView->currentIndex());
+    });
+    m_gridView->addAction(openGridItemAction);
+    m_gridView->addAction(focusSearchFieldAction);
 
-    m_searchField = new QLineEdit(this);
-    m_searchField->setPlaceholderText(i18n("Search (Ctrl+F)"));
+    connect(m_gridView, &QListView::doubleClicked, this, &MangaTreeWidget::openGridItem);
+    connect(m_gridView, &QListView::customContextMenuRequested, this, [this](QPoint point) {
+        treeViewContextMenu(m_gridView, point);
+    });
+    // the folder shown is gone after a reset
+    connect(m_treeProxyModel, &QAbstractItemModel::modelReset, this, [this]() {
+        setGridRootIndex({});
+    });
+
+    m_upButton = new QToolButton(this);
+    m_upButton->setIcon(QIcon::fromTheme(u"go-up"_s));
+    m_upButton->setToolTip(i18n("Parent folder"));
+    m_upButton->setEnabled(false);
+    connect(m_upButton, &QToolButton::clicked, this, [this]() {
+        setGridRootIndex(m_gridView->rootIndex().parent());
+    });
 
-    connect(m_searchField, &QLineEdit::textChanged, m_treeProxyModel, [this]() {
-        const auto regEx = QRegularExpression(m_searchField->text(), QRegularExpression::CaseInsensitiveOption);
-        m_treeProxyModel->setFilterRegularExpression(regEx);
+    m_gridButton = new QToolButton(this);
+    m_gridButton->setIcon(QIcon::fromTheme(u"view-list-icons"_s));
+    m_gridButton->setToolTip(i18n("Show covers in a grid"));
+    m_gridButton->setCheckable(true);
+    m_gridButton->setChecked(MangaReaderSettings::libraryGridView());
+    connect(m_gridButton, &QToolButton::toggled, this, [this](bool checked) {
+        setGridView(checked);
+        MangaReaderSettings::setLibraryGridView(checked);
+        MangaReaderSettings::self()->save();
     });
 
-    // connect(m_treeModel, &QFileSystemModel::directoryLoaded, this, [this]() {
-        // filter when model finished loading items
-        // m_searchField->setText(u""_s);
-        // disconnect(m_treeModel, &QFileSystemModel::directoryLoaded, nullptr, nullptr);
-    // });
+    m_searchField = new QLineEdit(this);
+    m_searchField->setPlaceholderText(i18n("Search (Ctrl+F)"));
+
+    connect(m_searchField, &QLineEdit::textChanged, this, &MangaTreeWidget::applySearch);
 
     connect(MangaReaderSettings::self(), &MangaReaderSettings::MangaFoldersChanged, this, [this]() {
         m_isEmpty = MangaReaderSettings::mangaFolders().isEmpty();
     });
 
+    auto searchLayout = new QHBoxLayout();
+    searchLayout->addWidget(m_searchField);
+    searchLayout->addWidget(m_upButton);
+    searchLayout->addWidget(m_gridButton);
+
     auto *l = new QVBoxLayout(this);
-    l->addWidget(m_searchField);
+    l->addLayout(searchLayout);
     l->addWidget(m_treeView);
+    l->addWidget(m_gridView);
+
+    setGridView(MangaReaderSettings::libraryGridView());
+}
+
+MangaTreeWidget::~MangaTreeWidget()
+{
+    m_searchBuildStop.request_stop();
 }
 
 QTreeView *MangaTreeWidget::treeView() const
@@ -108,7 +188,7 @@ QTreeView *MangaTreeWidget::treeView() const
     return m_treeView;
 }
 
-QFileSystemModel *MangaTreeWidget::treeModel() const
+LibraryModel *MangaTreeWidget::treeModel() const
 {
     return m_treeModel;
 }
@@ -120,16 +200,14 @@ QString MangaTreeWidget::getMangaFolder() const
 
 void MangaTreeWidget::setMangaFolder(const QString &newMangaFolder)
 {
-    const auto modelIndex = m_treeProxyModel->mapFromSource(m_treeModel->index(newMangaFolder));
     m_treeModel->setRootPath(newMangaFolder);
-    m_treeView->setRootIndex(modelIndex);
 
     m_mangaFolder = newMangaFolder;
 }
 
-void MangaTreeWidget::treeViewContextMenu(QPoint point)
+void MangaTreeWidget::treeViewContextMenu(QAbstractItemView *view, QPoint point)
 {
-    QModelIndex index = m_treeView->indexAt(point);
+    QModelIndex index = view->indexAt(point);
     const auto modelIndex = m_treeProxyModel->mapToSource(index);
     QString path = m_treeModel->filePath(modelIndex);
 
@@ -137,19 +215,19 @@ void MangaTreeWidget::treeViewContextMenu(QPoint point)
     menu->setMinimumWidth(200);
 
     auto load = new QAction(QIcon::fromTheme(u"arrow-down"_s), i18n("Load"));
-    m_treeView->addAction(load);
+    view->addAction(load);
 
     auto loadRecursive = new QAction(QIcon::fromTheme(u"arrow-down-double"_s), i18n("Load recursive"));
-    m_treeView->addAction(loadRecursive);
+    view->addAction(loadRecursive);
 
     auto rename = new QAction(QIcon::fromTheme(u"edit-rename"_s), i18n("Rename"));
-    m_treeView->addAction(rename);
+    view->addAction(rename);
 
     auto openPath = new QAction(QIcon::fromTheme(u"unknown"_s), i18n("Open"));
-    m_treeView->addAction(openPath);
+    view->addAction(openPath);
 
     auto openContainingFolder = new QAction(QIcon::fromTheme(u"folder-open"_s), i18n("Open containing folder"));
-    m_treeView->addAction(openContainingFolder);
+    view->addAction(openContainingFolder);
 
     menu->addAction(load);
     menu->addAction(loadRecursive);
@@ -202,13 +280,135 @@ bool MangaTreeWidget::isEmpty() const
     return m_isEmpty;
 }
 
-bool FSProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+void MangaTreeWidget::setGridView(bool enabled)
+{
+    m_treeView->setVisible(!enabled);
+    m_gridView->setVisible(enabled);
+    m_upButton->setVisible(enabled);
+    updateCovers();
+}
+
+void MangaTreeWidget::setGridRootIndex(const QModelIndex &index)
+{
+    m_gridView->setRootIndex(index);
+    m_upButton->setEnabled(index.isValid());
+}
+
+void MangaTreeWidget::openGridItem(const QModelIndex &index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    // folders of images and archives are read, series folders are browsed
+    if (m_treeProxyModel->hasChildren(index)) {
+        setGridRootIndex(index);
+        return;
+    }
+    const auto resume{false};
+    const auto recursive{false};
+    Q_EMIT open(filePath(index), resume, recursive);
+}
+
+void MangaTreeWidget::updateCovers()
+{
+    const bool showCovers = MangaReaderSettings::showCovers();
+    m_treeModel->setCoverLoader(showCovers ? m_coverLoader : nullptr);
+    // covers at the tree's default icon size are too small to tell apart
+    m_treeView->setIconSize(showCovers ? QSize(32, 32) : QSize());
+}
+
+void MangaTreeWidget::startSearchBuild(bool readArchives)
+{
+    m_searchBuildStop.request_stop();
+    m_searchBuildStop = std::stop_source{};
+    const std::stop_token stopToken = m_searchBuildStop.get_token();
+
+    struct Build {
+        LibrarySearch search;
+        LibrarySearch::ContentsMap contents;
+    };
+    const LibraryIndex &index = m_treeModel->libraryIndex();
+    const LibrarySearch::ContentsMap contents = m_archiveContentsRoot == index.rootPath() ? m_archiveContents : LibrarySearch::ContentsMap{};
+    const bool loadContents = m_archiveContentsRoot != index.rootPath();
+
+    QtConcurrent::run([index, contents, loadContents, readArchives, stopToken]() {
+        Build build;
+        build.contents = loadContents ? LibrarySearch::loadContents(LibrarySearch::contentsCachePath(index.rootPath())) : contents;
+        if (readArchives) {
+            build.contents = LibrarySearch::readArchiveContents(index, build.contents, stopToken);
+        }
+        build.search = LibrarySearch::build(index, build.contents, stopToken);
+        return build;
+    }).then(this, [this, rootPath = index.rootPath(), readArchives, stopToken](const Build &build) {
+        if (stopToken.stop_requested()) {
+            return;
+        }
+        m_search = build.search;
+        m_archiveContents = build.contents;
+        m_archiveContentsRoot = rootPath;
+        m_lastQuery.clear();
+        applySearch();
+
+        if (readArchives) {
+            QThreadPool::globalInstance()->start([contents = build.contents, rootPath]() {
+                LibrarySearch::saveContents(contents, LibrarySearch::contentsCachePath(rootPath));
+            });
+        } else if (MangaReaderSettings::searchArchiveContents()) {
+            // names are searchable already, archives that are new or changed are read next
+            startSearchBuild(true);
+        }
+    });
+}
+
+void MangaTreeWidget::applySearch()
+{
+    const QString query = m_searchField->text();
+    if (query.trimmed().isEmpty()) {
+        m_lastQuery.clear();
+        m_lastResults.clear();
+        m_treeProxyModel->clearMatches();
+        return;
+    }
+
+    // typing more only narrows down the results
+    m_lastResults = !m_lastQuery.isEmpty() && query.startsWith(m_lastQuery) ? m_search.refine(query, m_lastResults)
+                                                                          : m_search.search(query);
+    m_lastQuery = query;
+
+    QSet<QString> matches;
+    matches.reserve(m_lastResults.size());
+    for (qint32 id : std::as_const(m_lastResults)) {
+        matches.insert(m_search.path(id));
+    }
+    m_treeProxyModel->setMatches(matches);
+}
+
+void LibraryProxyModel::setMatches(const QSet<QString> &relativePaths)
+{
+    beginFilterChange();
+    m_matches = relativePaths;
+    m_filtering = true;
+    endFilterChange(QSortFilterProxyModel::Direction::Rows);
+}
+
+void LibraryProxyModel::clearMatches()
+{
+    if (!m_filtering) {
+        return;
+    }
+    beginFilterChange();
+    m_matches.clear();
+    m_filtering = false;
+    endFilterChange(QSortFilterProxyModel::Direction::Rows);
+}
+
+bool LibraryProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    QFileSystemModel *sm = qobject_cast<QFileSystemModel*>(sourceModel());
-    if (source_parent == sm->index(sm->rootPath())) {
-        return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
+    if (!m_filtering) {
+        return true;
     }
-    return true;
+    auto model = static_cast<LibraryModel *>(sourceModel());
+    return m_matches.contains(model->relativePath(model->index(source_row, 0, source_parent)));
 }
 
 QModelIndex MangaTreeWidget::currentModelIndex(const QString &path) const
@@ -8,17 +8,41 @@
 #define MANGATREEVIEW_H
 
 #include <QObject>
+#include <QSet>
 #include <QSortFilterProxyModel>
 #include <QWidget>
 
+#include <stop_token>
+
+#include "librarysearch.h"
+
+class QAbstractItemView;
+class QListView;
 class QTreeView;
-class QFileSystemModel;
+class QTimer;
+class QToolButton;
+class CoverLoader;
+class LibraryModel;
 class QLineEdit;
 
-class FSProxyModel : public QSortFilterProxyModel
+class LibraryProxyModel : public QSortFilterProxyModel
 {
+public:
+    using QSortFilterProxyModel::QSortFilterProxyModel;
+
+    /**
+     * Shows only the entries with these paths, relative to the library folder,
+     * their parents and their content
+     */
+    void setMatches(const QSet<QString> &relativePaths);
+    void clearMatches();
+
 protected:
-    virtual bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+
+private:
+    QSet<QString> m_matches;
+    bool m_filtering{false};
 };
 
 class MangaTreeWidget : public QWidget
@@ -26,10 +50,11 @@ class MangaTreeWidget : public QWidget
     Q_OBJECT
 public:
     MangaTreeWidget();
+    ~MangaTreeWidget() override;
 
     QTreeView *treeView() const;
 
-    QFileSystemModel *treeModel() const;
+    LibraryModel *treeModel() const;
 
     QString getMangaFolder() const;
     void setMangaFolder(const QString &newMangaFolder);
@@ -47,14 +72,32 @@ Q_SIGNALS:
     void openContextMenu();
 
 private:
-    void treeViewContextMenu(QPoint point);
-
-    QTreeView        *m_treeView{nullptr};
-    QFileSystemModel *m_treeModel{nullptr};
-    FSProxyModel     *m_treeProxyModel{nullptr};
-    QLineEdit        *m_searchField{nullptr};
-    QString           m_mangaFolder;
-    bool              m_isEmpty{true};
+    void treeViewContextMenu(QAbstractItemView *view, QPoint point);
+    void startSearchBuild(bool readArchives);
+    void applySearch();
+    void setGridView(bool enabled);
+    void setGridRootIndex(const QModelIndex &index);
+    void openGridItem(const QModelIndex &index);
+    void updateCovers();
+
+    QTreeView             *m_treeView{nullptr};
+    QListView             *m_gridView{nullptr};
+    QToolButton           *m_upButton{nullptr};
+    QToolButton           *m_gridButton{nullptr};
+    LibraryModel          *m_treeModel{nullptr};
+    // created after the model, so it outlives it
+    CoverLoader           *m_coverLoader{nullptr};
+    LibraryProxyModel     *m_treeProxyModel{nullptr};
+    QLineEdit             *m_searchField{nullptr};
+    QString                m_mangaFolder;
+    bool                   m_isEmpty{true};
+    LibrarySearch          m_search;
+    LibrarySearch::ContentsMap m_archiveContents;
+    QString                m_archiveContentsRoot;
+    QTimer                *m_searchBuildTimer{nullptr};
+    std::stop_source       m_searchBuildStop;
+    QString                m_lastQuery;
+    QList<qint32>          m_lastResults;
 };
 
 #endif // MANGATREEVIEW_H
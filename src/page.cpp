@@ -11,7 +11,10 @@
 #include <QScrollBar>
 #include <QStyleOptionGraphicsItem>
 
+#include "grayscale.h"
 #include "page.h"
+#include "stallwatchdog.h"
+#include "trace.h"
 #include "view.h"
 
 Page::Page(QSize sourceSize, QGraphicsItem *parent)
@@ -29,6 +32,11 @@ Page::~Page()
     deleteImage();
 }
 
+int Page::type() const
+{
+    return Type;
+}
+
 void Page::setMaxWidth(int maxWidth)
 {
     m_maxWidth = maxWidth;
@@ -37,11 +45,13 @@ void Page::setMaxWidth(int maxWidth)
 void Page::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
     Q_UNUSED(widget);
-    if (m_pixmap.isNull()) {
+    if (isImageDeleted() && m_preview.isNull()) {
         return;
     }
+    TRACE_SCOPE("paint", m_number);
 
-    const QRectF pixRect(0, 0, m_pixmap.width(), m_pixmap.height());
+    const QSizeF size = m_pixmap.isNull() || isImageOutdated() ? QSizeF(m_scaledSize) : m_pixmap.deviceIndependentSize();
+    const QRectF pixRect(QPointF(0, 0), size);
 
     painter->save();
     painter->setPen(QPen(MangaReaderSettings::borderColor(), 1));
@@ -49,12 +59,40 @@ void Page::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
     if (MangaReaderSettings::vPageSpacing() > 0) {
         painter->drawRect(pixRect.adjusted(-0.5, -0.5, 0.5, 0.5));
     } else {
-        painter->drawLine(-1, 0, -1, m_pixmap.height());
-        painter->drawLine(m_pixmap.width() + 1, 0, m_pixmap.width() + 1, m_pixmap.height());
+        painter->drawLine(QPointF(-1, 0), QPointF(-1, size.height()));
+        painter->drawLine(QPointF(size.width() + 1, 0), QPointF(size.width() + 1, size.height()));
     }
 
     painter->restore();
-    painter->drawPixmap(option->exposedRect, m_pixmap, option->exposedRect);
+
+    if (isTiled()) {
+        for (auto it = m_tiles.cbegin(); it != m_tiles.cend(); ++it) {
+            const QRectF tileArea = tileRect(it.key());
+            const QRectF exposed = option->exposedRect.intersected(tileArea);
+            if (exposed.isEmpty()) {
+                continue;
+            }
+            const qreal dpr = it.value().devicePixelRatio();
+            const QRectF source = exposed.translated(-tileArea.topLeft());
+            painter->drawPixmap(exposed, it.value(), QRectF(source.topLeft() * dpr, source.size() * dpr));
+        }
+        return;
+    }
+
+    if (m_pixmap.isNull()) {
+        // low resolution preview, scaled up, while the full quality page is decoded
+        painter->drawPixmap(pixRect, m_preview, QRectF(m_preview.rect()));
+        return;
+    }
+
+    if (isImageOutdated()) {
+        painter->drawPixmap(pixRect, m_pixmap, QRectF(m_pixmap.rect()));
+        return;
+    }
+    // the source rect is in device pixels
+    const qreal dpr = m_pixmap.devicePixelRatio();
+    const QRectF exposed = option->exposedRect;
+    painter->drawPixmap(exposed, m_pixmap, QRectF(exposed.topLeft() * dpr, exposed.size() * dpr));
 }
 
 QRectF Page::rect() const
@@ -106,13 +144,143 @@ auto Page::boundingRect() const -> QRectF
 
 auto Page::isImageDeleted() const -> bool
 {
+    if (isTiled()) {
+        return m_tiles.isEmpty();
+    }
     return m_pixmap.isNull();
 }
 
 void Page::deleteImage()
 {
     m_pixmap = QPixmap{};
+    m_preview = QPixmap{};
     m_image = QImage{};
+    m_tiles.clear();
+}
+
+bool Page::isImageOutdated() const
+{
+    if (m_pixmap.isNull() || isTiled()) {
+        return false;
+    }
+    // moved to a screen with a different scale factor
+    if (!qFuzzyCompare(m_pixmap.devicePixelRatio(), pixelRatio())) {
+        return true;
+    }
+    // allow for rounding differences when scaling with a kept aspect ratio
+    const QSize size = decodeSize();
+    return qAbs(m_pixmap.width() - size.width()) > 1
+        || qAbs(m_pixmap.height() - size.height()) > 1;
+}
+
+qint64 Page::memoryFootprint() const
+{
+    auto pixmapBytes = [](const QPixmap &pixmap) -> qint64 {
+        return static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    };
+
+    qint64 bytes = m_image.sizeInBytes() + pixmapBytes(m_pixmap) + pixmapBytes(m_preview);
+    for (const QPixmap &tile : m_tiles) {
+        bytes += pixmapBytes(tile);
+    }
+    return bytes;
+}
+
+bool Page::hasPreview() const
+{
+    return !m_preview.isNull();
+}
+
+void Page::setPreview(const QImage &image)
+{
+    // the full quality page arrived first
+    if (!m_pixmap.isNull() || isTiled() || image.isNull()) {
+        return;
+    }
+    m_preview = QPixmap::fromImage(image);
+    update();
+}
+
+bool Page::isTiled() const
+{
+    return decodeSize().height() > MaxUntiledHeight
+        || static_cast<qint64>(m_sourceSize.width()) * m_sourceSize.height() > MaxUntiledSourcePixels;
+}
+
+int Page::tileCount() const
+{
+    if (m_scaledSize.isEmpty()) {
+        return 0;
+    }
+    return (m_scaledSize.height() + TileHeight - 1) / TileHeight;
+}
+
+QRect Page::tileRect(int tile) const
+{
+    const int top = tile * TileHeight;
+    const int bottom = std::min(top + TileHeight, m_scaledSize.height());
+    return QRect(0, top, m_scaledSize.width(), bottom - top);
+}
+
+QRect Page::tileSourceRect(int tile) const
+{
+    // map the tile's vertical range from scaled to source coordinates,
+    // rounding both edges the same way so adjacent tiles don't overlap or leave gaps
+    const QRect rect = tileRect(tile);
+    const double scale = static_cast<double>(m_sourceSize.height()) / m_scaledSize.height();
+    const int top = qRound(rect.top() * scale);
+    const int bottom = std::min(qRound((rect.bottom() + 1) * scale), m_sourceSize.height());
+    return QRect(0, top, m_sourceSize.width(), bottom - top);
+}
+
+QSize Page::tileDecodeSize(int tile) const
+{
+    return (QSizeF(tileRect(tile).size()) * pixelRatio()).toSize();
+}
+
+QList<int> Page::tilesIntersecting(const QRectF &rect) const
+{
+    QList<int> tiles;
+    const QRectF pageRect(QPointF(0, 0), QSizeF(m_scaledSize));
+    const QRectF visible = rect.intersected(pageRect);
+    if (visible.isEmpty()) {
+        return tiles;
+    }
+
+    const int first = static_cast<int>(visible.top()) / TileHeight;
+    const int last = std::min(static_cast<int>(visible.bottom()) / TileHeight, tileCount() - 1);
+    for (int tile = first; tile <= last; ++tile) {
+        tiles.append(tile);
+    }
+    return tiles;
+}
+
+bool Page::hasTile(int tile) const
+{
+    return m_tiles.contains(tile);
+}
+
+void Page::setTile(int tile, const QImage &image)
+{
+    // drop tiles requested before the page was resized
+    if (!isTiled() || tile >= tileCount() || image.size() != tileDecodeSize(tile)) {
+        return;
+    }
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(pixelRatio());
+    m_tiles.insert(tile, pixmap);
+    update(tileRect(tile));
+}
+
+void Page::keepTiles(const QList<int> &tiles)
+{
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        if (tiles.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_tiles.erase(it);
+        }
+    }
 }
 
 const QImage &Page::image() const
@@ -124,13 +292,32 @@ void Page::setImage(const QImage &image)
 {
     m_image = image;
     redrawImage();
+    if (MangaReaderSettings::leanPageMemory()) {
+        // only the paint ready pixmap is kept, rescaling and copying
+        // the page get it from the page cache or a new decode
+        m_image = QImage{};
+    }
+}
+
+const QPixmap &Page::pixmap() const
+{
+    return m_pixmap;
 }
 
 void Page::redrawImage()
 {
+    TRACE_SCOPE("redrawImage", m_number);
+    STALL_SCOPE("Page::redrawImage");
     calculateScaledSize();
+    if (isTiled()) {
+        // tiles have to be decoded again at the new size
+        m_tiles.clear();
+        m_image = QImage{};
+        m_pixmap = QPixmap{};
+        return;
+    }
     if (!m_image.isNull()) {
-        auto scaledImage = m_image.scaled(m_scaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        auto scaledImage = Grayscale::scaled(m_image, decodeSize(), Qt::KeepAspectRatio);
         redraw(scaledImage);
     }
 }
@@ -142,8 +329,10 @@ void Page::calculateScaledSize()
     }
 
     const int maxWidth = MangaReaderSettings::maxWidth();
-    const bool fitWidth = MangaReaderSettings::fitWidth();
-    const bool fitHeight = MangaReaderSettings::fitHeight();
+    // in paged mode the page always fits the screen
+    const bool paged = MangaReaderSettings::pagedMode();
+    const bool fitWidth = paged || MangaReaderSettings::fitWidth();
+    const bool fitHeight = paged || MangaReaderSettings::fitHeight();
     const bool upScale = MangaReaderSettings::upScale();
     const int hSpacing = MangaReaderSettings::hPageSpacing();
 
@@ -175,14 +364,17 @@ void Page::calculateScaledSize()
 void Page::redraw(const QImage &image)
 {
     // reuse existing pixmap if of right size
-    if (!m_pixmap.isNull() && m_pixmap.size() == image.size()) {
+    const qreal dpr = pixelRatio();
+    if (!m_pixmap.isNull() && m_pixmap.size() == image.size() && qFuzzyCompare(m_pixmap.devicePixelRatio(), dpr)) {
         QPainter p(&m_pixmap);
-        p.drawImage(0, 0, image);
+        p.drawImage(QRectF(QPointF(0, 0), m_pixmap.deviceIndependentSize()), image);
         p.end();
     } else {
         m_pixmap = QPixmap();
         m_pixmap = QPixmap::fromImage(image);
+        m_pixmap.setDevicePixelRatio(dpr);
     }
+    m_preview = QPixmap{};
     update();
 }
 
@@ -211,6 +403,16 @@ auto Page::scaledSize() -> QSize
     return m_scaledSize;
 }
 
+qreal Page::pixelRatio() const
+{
+    return m_view ? m_view->decodePixelRatio() : 1.0;
+}
+
+QSize Page::decodeSize() const
+{
+    return (QSizeF(m_scaledSize) * pixelRatio()).toSize();
+}
+
 auto Page::sourceSize() -> QSize
 {
     return m_sourceSize;
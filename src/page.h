@@ -8,6 +8,7 @@
 #define PAGE_H
 
 #include <QGraphicsItem>
+#include <QMap>
 
 class QPixmap;
 class View;
@@ -16,19 +17,59 @@ class Page : public QGraphicsItem
 {
 public:
     Page(QSize sourceSize, QGraphicsItem *parent = nullptr);
+
+    enum { Type = UserType + 1 };
+    int type() const override;
+
+    // tall pages (webtoon strips) and heavily zoomed pages are split
+    // in tiles of this height, only the tiles near the viewport are kept
+    static constexpr int TileHeight{1024};
+    static constexpr int MaxUntiledHeight{4 * TileHeight};
+    // decoding bigger images in one go hits Qt's image allocation limit
+    static constexpr qint64 MaxUntiledSourcePixels{8192 * 8192};
     ~Page();
     void setView(View *view);
     void setMaxWidth(int maxWidth);
     const QImage &image() const;
     void setImage(const QImage &image);
+    const QPixmap &pixmap() const;
     void redrawImage();
     void calculateScaledSize();
     void redraw(const QImage &image);
     void deleteImage();
     void setScaledSize(QSize size);
     auto scaledSize() -> QSize;
+    /**
+     * Device pixels per logical pixel the page is decoded at
+     */
+    qreal pixelRatio() const;
+    /**
+     * Size, in device pixels, the page has to be decoded at
+     */
+    QSize decodeSize() const;
     auto sourceSize() -> QSize;
     auto isImageDeleted() const -> bool;
+    /**
+     * The pixmap was made for a different size and is painted scaled until replaced
+     */
+    bool isImageOutdated() const;
+    /**
+     * Bytes used by the images and pixmaps held by the page
+     */
+    qint64 memoryFootprint() const;
+    bool hasPreview() const;
+    void setPreview(const QImage &image);
+
+    bool isTiled() const;
+    int tileCount() const;
+    QRect tileRect(int tile) const;
+    QRect tileSourceRect(int tile) const;
+    QSize tileDecodeSize(int tile) const;
+    QList<int> tilesIntersecting(const QRectF &rect) const;
+    bool hasTile(int tile) const;
+    void setTile(int tile, const QImage &image);
+    void keepTiles(const QList<int> &tiles);
+
     auto zoom() const -> double;
     void setZoom(double zoom);
 
@@ -57,6 +98,8 @@ private:
     bool     m_isZoomToggled{false};
     double   m_ratio{1.0};
     QPixmap  m_pixmap;
+    QPixmap  m_preview;
+    QMap<int, QPixmap> m_tiles;
     QImage   m_image;
     QString  m_filename;
     QRectF   m_rect;
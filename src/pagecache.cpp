@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "pagecache.h"
+
+#include <QMutexLocker>
+
+PageCache::PageCache(qint64 maxCost)
+    : m_maxCost{maxCost}
+{
+}
+
+qint64 PageCache::maxCost() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxCost;
+}
+
+void PageCache::setMaxCost(qint64 maxCost)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxCost = maxCost;
+    trim();
+}
+
+qint64 PageCache::totalCost() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalCost;
+}
+
+ImagePyramid PageCache::find(int pageNumber)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(pageNumber);
+    if (it == m_entries.end()) {
+        return {};
+    }
+    it->lastUse = ++m_useCounter;
+    return it->pyramid;
+}
+
+void PageCache::insert(int pageNumber, const ImagePyramid &pyramid)
+{
+    if (pyramid.isNull()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const qint64 cost = pyramid.sizeInBytes();
+    if (cost > m_maxCost) {
+        return;
+    }
+
+    auto it = m_entries.find(pageNumber);
+    if (it != m_entries.end()) {
+        m_totalCost -= it->cost;
+    }
+    m_entries.insert(pageNumber, {pyramid, cost, ++m_useCounter});
+    m_totalCost += cost;
+    trim();
+}
+
+void PageCache::remove(int pageNumber)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(pageNumber);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_totalCost -= it->cost;
+    m_entries.erase(it);
+}
+
+void PageCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_totalCost = 0;
+}
+
+void PageCache::setEvictionHandler(const std::function<void(int, const ImagePyramid &)> &handler)
+{
+    QMutexLocker locker(&m_mutex);
+    m_evictionHandler = handler;
+}
+
+void PageCache::trim()
+{
+    // the cache only holds a few dozen pages, a linear search
+    // for the oldest entry is cheaper than maintaining a list
+    while (m_totalCost > m_maxCost && !m_entries.isEmpty()) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) {
+                oldest = it;
+            }
+        }
+        m_totalCost -= oldest->cost;
+        if (m_evictionHandler) {
+            m_evictionHandler(oldest.key(), oldest->pyramid);
+        }
+        m_entries.erase(oldest);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include <QHash>
+#include <QMutex>
+
+#include <functional>
+
+#include "imagepyramid.h"
+
+/**
+ * Thread safe, memory bounded cache of decoded pages.
+ * When the budget is exceeded the least recently used pages are dropped.
+ */
+class PageCache
+{
+public:
+    explicit PageCache(qint64 maxCost = 256 * 1024 * 1024);
+
+    qint64 maxCost() const;
+    void setMaxCost(qint64 maxCost);
+    qint64 totalCost() const;
+
+    ImagePyramid find(int pageNumber);
+    void insert(int pageNumber, const ImagePyramid &pyramid);
+    void remove(int pageNumber);
+    void clear();
+
+    /**
+     * Called, with the cache locked, for every page dropped to stay within budget
+     */
+    void setEvictionHandler(const std::function<void(int, const ImagePyramid &)> &handler);
+
+private:
+    struct Entry {
+        ImagePyramid pyramid;
+        qint64 cost{0};
+        quint64 lastUse{0};
+    };
+
+    void trim();
+
+    mutable QMutex m_mutex;
+    QHash<int, Entry> m_entries;
+    qint64 m_maxCost{0};
+    qint64 m_totalCost{0};
+    quint64 m_useCounter{0};
+    std::function<void(int, const ImagePyramid &)> m_evictionHandler;
+};
+
+#endif // PAGECACHE_H
@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef PAGEIMAGE_H
+#define PAGEIMAGE_H
+
+#include <QImage>
+
+/**
+ * Result of Manga::requestPage, move only so a page is never copied
+ * on its way from the decoding thread to whoever asked for it
+ */
+struct PageImage {
+    PageImage() = default;
+    PageImage(int pageNumber, QImage image)
+        : pageNumber{pageNumber}
+        , image{std::move(image)}
+    {
+    }
+    PageImage(const PageImage &) = delete;
+    PageImage &operator=(const PageImage &) = delete;
+    PageImage(PageImage &&) = default;
+    PageImage &operator=(PageImage &&) = default;
+
+    int pageNumber{-1};
+    QImage image;
+};
+
+#endif // PAGEIMAGE_H
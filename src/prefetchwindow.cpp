@@ -0,0 +1,70 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "prefetchwindow.h"
+
+#include <QtMath>
+
+// without a new sample for this long scrolling is considered stopped
+static constexpr qint64 IdleTimeout{250};
+// weight of the newest sample in the velocity average
+static constexpr qreal VelocitySmoothing{0.3};
+// the band never looks further ahead than this many viewports
+static constexpr qreal MaxViewportsAhead{10};
+// decoding can't be predicted before the first page is done, assume a slow one
+static constexpr qreal DefaultDecodeTime{50};
+
+void PrefetchWindow::addScrollSample(qint64 msecs, qreal position)
+{
+    if (m_lastSample < 0 || msecs - m_lastSample > IdleTimeout) {
+        m_velocity = 0;
+    } else if (msecs > m_lastSample) {
+        const qreal sample = (position - m_lastPosition) / static_cast<qreal>(msecs - m_lastSample);
+        m_velocity += (sample - m_velocity) * VelocitySmoothing;
+    }
+    m_lastSample = msecs;
+    m_lastPosition = position;
+}
+
+void PrefetchWindow::setDecodeTime(qreal msecs)
+{
+    m_decodeTime = msecs;
+}
+
+qreal PrefetchWindow::velocity(qint64 msecs) const
+{
+    if (m_lastSample < 0 || msecs - m_lastSample > IdleTimeout) {
+        return 0;
+    }
+    return m_velocity;
+}
+
+PrefetchWindow::Band PrefetchWindow::band(qint64 msecs, qreal viewportHeight, qreal pageHeight, qreal pendingScroll, qreal maxExtent) const
+{
+    const qreal speed = velocity(msecs);
+    if (qFuzzyIsNull(speed) && qFuzzyIsNull(pendingScroll)) {
+        return {viewportHeight, viewportHeight};
+    }
+
+    // time until the pages of a whole viewport are ready
+    const qreal decodeTime = m_decodeTime > 0 ? m_decodeTime : DefaultDecodeTime;
+    const qreal pagesPerViewport = pageHeight > 0 ? qCeil(viewportHeight / pageHeight) : 1;
+    const qreal horizon = decodeTime * (pagesPerViewport + 1);
+
+    // the direction of travel is where smooth scrolling is headed, or the measured one
+    const bool down = qFuzzyIsNull(pendingScroll) ? speed > 0 : pendingScroll > 0;
+    qreal ahead = viewportHeight + qAbs(pendingScroll) + qAbs(speed) * horizon;
+    ahead = qMin(ahead, viewportHeight * MaxViewportsAhead);
+    qreal behind = viewportHeight / 2;
+
+    // stay within the memory budget, dropping what's behind first,
+    // but always keep at least a viewport ahead
+    const qreal outside = qMax(maxExtent - viewportHeight, viewportHeight);
+    behind = qMin(behind, outside - viewportHeight);
+    ahead = qMin(ahead, outside - behind);
+
+    return down ? Band{behind, ahead} : Band{ahead, behind};
+}
@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef PREFETCHWINDOW_H
+#define PREFETCHWINDOW_H
+
+#include <QtGlobal>
+
+/**
+ * Decides how far above and below the viewport pages are loaded.
+ *
+ * When still, one viewport is loaded on each side. While scrolling, the side
+ * in the direction of travel grows with the distance covered in the time
+ * it takes to decode a viewport of pages, and the other side shrinks.
+ */
+class PrefetchWindow
+{
+public:
+    struct Band {
+        qreal before{0};
+        qreal after{0};
+    };
+
+    /**
+     * Records the scroll position at `msecs`, timestamps must not go backwards
+     */
+    void addScrollSample(qint64 msecs, qreal position);
+    /**
+     * Average time a page takes to be decoded and scaled
+     */
+    void setDecodeTime(qreal msecs);
+    /**
+     * Scroll speed at `msecs` in pixels per millisecond, negative when scrolling up
+     */
+    qreal velocity(qint64 msecs) const;
+
+    /**
+     * Extent to load above (`before`) and below (`after`) the viewport.
+     * `pendingScroll` is the distance smooth scrolling still has to travel,
+     * `maxExtent` caps the height of the whole band, viewport included.
+     */
+    Band band(qint64 msecs, qreal viewportHeight, qreal pageHeight, qreal pendingScroll, qreal maxExtent) const;
+
+private:
+    qreal m_velocity{0};
+    qreal m_lastPosition{0};
+    qint64 m_lastSample{-1};
+    qreal m_decodeTime{0};
+};
+
+#endif // PREFETCHWINDOW_H
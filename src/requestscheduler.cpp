@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "requestscheduler.h"
+
+#include <QSet>
+#include <QtMath>
+
+#include <utility>
+
+using namespace Qt::StringLiterals;
+
+// below this, in pages per second, the reader is considered still
+static constexpr qreal MinimumVelocity{0.1};
+// pages behind the scroll direction count as this many times further away
+static constexpr qreal BehindPenalty{4.0};
+static RequestScheduler::Policy s_defaultPolicy{RequestScheduler::Policy::Lifo};
+
+std::unique_ptr<RequestScheduler> RequestScheduler::create(Policy policy)
+{
+    switch (policy) {
+    case Policy::Lifo:
+        return std::make_unique<LifoScheduler>();
+    case Policy::Distance:
+        return std::make_unique<DistanceScheduler>();
+    case Policy::Velocity:
+        return std::make_unique<VelocityScheduler>();
+    }
+    return std::make_unique<LifoScheduler>();
+}
+
+QString RequestScheduler::policyName(Policy policy)
+{
+    switch (policy) {
+    case Policy::Lifo:
+        return u"lifo"_s;
+    case Policy::Distance:
+        return u"distance"_s;
+    case Policy::Velocity:
+        return u"velocity"_s;
+    }
+    return {};
+}
+
+std::optional<RequestScheduler::Policy> RequestScheduler::policyFromName(const QString &name)
+{
+    for (auto policy : {Policy::Lifo, Policy::Distance, Policy::Velocity}) {
+        if (policyName(policy) == name) {
+            return policy;
+        }
+    }
+    return std::nullopt;
+}
+
+RequestScheduler::Policy RequestScheduler::defaultPolicy()
+{
+    return s_defaultPolicy;
+}
+
+void RequestScheduler::setDefaultPolicy(Policy policy)
+{
+    s_defaultPolicy = policy;
+}
+
+void RequestScheduler::add(std::unique_ptr<ImageRequest> request)
+{
+    m_requests.push_back(std::move(request));
+}
+
+void RequestScheduler::addReplacing(std::vector<std::unique_ptr<ImageRequest>> requests)
+{
+    QSet<ImageRequestKey> requestedPages;
+    for (const auto &request : requests) {
+        requestedPages.insert(requestKey(request.get()));
+    }
+
+    // Remove the pending requests that target pages already present in the
+    // new request set. This prevents duplicate work and ensures that only the
+    // most recent request for a page remains in the queue.
+    // Requests made through add() have their own consumer and are kept.
+    std::erase_if(m_requests, [&requestedPages](const std::unique_ptr<ImageRequest> &request) {
+        return request->emitSignals && requestedPages.contains(requestKey(request.get()));
+    });
+
+    for (auto &request : requests) {
+        request->emitSignals = true;
+        m_requests.push_back(std::move(request));
+    }
+}
+
+std::unique_ptr<ImageRequest> RequestScheduler::takeNext()
+{
+    std::erase_if(m_requests, [](const std::unique_ptr<ImageRequest> &request) {
+        return request->promise.isCanceled();
+    });
+    if (m_requests.empty()) {
+        return nullptr;
+    }
+
+    const auto next = m_requests.begin() + pick();
+    std::unique_ptr<ImageRequest> request = std::move(*next);
+    m_requests.erase(next);
+    return request;
+}
+
+std::vector<std::unique_ptr<ImageRequest>> RequestScheduler::takeAll()
+{
+    return std::exchange(m_requests, {});
+}
+
+void RequestScheduler::clear()
+{
+    // dropped promises cancel their futures
+    m_requests.clear();
+}
+
+qsizetype RequestScheduler::size() const
+{
+    return static_cast<qsizetype>(m_requests.size());
+}
+
+bool RequestScheduler::isEmpty() const
+{
+    return m_requests.empty();
+}
+
+void RequestScheduler::setScrollState(const ScrollState &state)
+{
+    m_scrollState = state;
+}
+
+bool RequestScheduler::usesScrollState() const
+{
+    return false;
+}
+
+qsizetype LifoScheduler::pick() const
+{
+    // highest priority first, the newest among equals
+    qsizetype next{0};
+    for (qsizetype i = 1; i < size(); ++i) {
+        if (m_requests.at(i)->priority >= m_requests.at(next)->priority) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+bool DistanceScheduler::usesScrollState() const
+{
+    return true;
+}
+
+qsizetype DistanceScheduler::pick() const
+{
+    qsizetype next{0};
+    qreal nextCost = cost(m_requests.front().get());
+    for (qsizetype i = 1; i < size(); ++i) {
+        const ImageRequest *request = m_requests.at(i).get();
+        const ImageRequest *best = m_requests.at(next).get();
+        if (request->priority != best->priority) {
+            if (request->priority > best->priority) {
+                next = i;
+                nextCost = cost(request);
+            }
+            continue;
+        }
+        // previews are cheap and show something right away, like with lifo they go first
+        if (request->preview != best->preview) {
+            if (request->preview) {
+                next = i;
+                nextCost = cost(request);
+            }
+            continue;
+        }
+        const qreal requestCost = cost(request);
+        if (requestCost <= nextCost) {
+            next = i;
+            nextCost = requestCost;
+        }
+    }
+    return next;
+}
+
+qreal DistanceScheduler::cost(const ImageRequest *request) const
+{
+    // +0.5, the distance to the page's center
+    return qAbs(request->pageNumber + 0.5 - m_scrollState.position);
+}
+
+qreal VelocityScheduler::cost(const ImageRequest *request) const
+{
+    const qreal distance = request->pageNumber + 0.5 - m_scrollState.position;
+    if (qAbs(m_scrollState.velocity) < MinimumVelocity) {
+        return qAbs(distance);
+    }
+    // pages ahead are needed in the order they scroll into view,
+    // the ones behind only if the reader turns around
+    const bool ahead = (distance >= 0) == (m_scrollState.velocity > 0);
+    return ahead ? qAbs(distance) : qAbs(distance) * BehindPenalty;
+}
@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <QString>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "imagerequest.h"
+
+/**
+ * Queue of pending image requests, subclasses decide which one is decoded next.
+ * Higher priority requests always go first, policies only order requests of
+ * the same priority. Not thread safe, Manga guards it with a mutex.
+ */
+class RequestScheduler
+{
+public:
+    enum class Policy {
+        // the newest request first, what the view asked for last is usually what's on screen
+        Lifo,
+        // the request closest to the viewport first
+        Distance,
+        // like Distance, but pages behind the scroll direction wait
+        Velocity,
+    };
+
+    struct ScrollState {
+        // page at the center of the viewport, with the fraction scrolled into the next one
+        qreal position{0};
+        // pages per second, positive when scrolling down
+        qreal velocity{0};
+    };
+
+    static std::unique_ptr<RequestScheduler> create(Policy policy);
+    static QString policyName(Policy policy);
+    /**
+     * The policy policyName() gives `name`, nothing for an unknown name
+     */
+    static std::optional<Policy> policyFromName(const QString &name);
+    /**
+     * The policy mangas start with, lifo unless changed at startup
+     */
+    static Policy defaultPolicy();
+    static void setDefaultPolicy(Policy policy);
+
+    virtual ~RequestScheduler() = default;
+
+    void add(std::unique_ptr<ImageRequest> request);
+    /**
+     * Queues `requests`, pending requests for the same page, tile and preview
+     * are dropped if they were also made through addReplacing()
+     */
+    void addReplacing(std::vector<std::unique_ptr<ImageRequest>> requests);
+    /**
+     * Removes the next request to decode from the queue, canceled requests are dropped.
+     * Returns nullptr when there is nothing left.
+     */
+    std::unique_ptr<ImageRequest> takeNext();
+    /**
+     * Empties the queue, in the order the requests were added
+     */
+    std::vector<std::unique_ptr<ImageRequest>> takeAll();
+    void clear();
+    qsizetype size() const;
+    bool isEmpty() const;
+
+    void setScrollState(const ScrollState &state);
+    /**
+     * Whether pick() looks at the scroll state, it needn't be updated otherwise
+     */
+    virtual bool usesScrollState() const;
+
+protected:
+    /**
+     * Index in `m_requests` of the request to decode next, `m_requests` is never empty
+     */
+    virtual qsizetype pick() const = 0;
+
+    std::vector<std::unique_ptr<ImageRequest>> m_requests;
+    ScrollState m_scrollState;
+};
+
+class LifoScheduler : public RequestScheduler
+{
+protected:
+    qsizetype pick() const override;
+};
+
+class DistanceScheduler : public RequestScheduler
+{
+public:
+    bool usesScrollState() const override;
+
+protected:
+    qsizetype pick() const override;
+    /**
+     * Lower goes first
+     */
+    virtual qreal cost(const ImageRequest *request) const;
+};
+
+class VelocityScheduler : public DistanceScheduler
+{
+protected:
+    qreal cost(const ImageRequest *request) const override;
+};
+
+#endif // REQUESTSCHEDULER_H
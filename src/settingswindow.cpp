@@ -111,6 +111,24 @@ SettingsWindow::SettingsWindow(QWidget *parent, KConfigSkeleton *skeleton)
     // end 2 page per row
 
 
+    // paged mode
+    auto pagedMode = new QCheckBox(this);
+    pagedMode->setObjectName(QStringLiteral("kcfg_PagedMode"));
+    pagedMode->setText(i18n("Paged mode"));
+    pagedMode->setChecked(MangaReaderSettings::pagedMode());
+    pagedMode->setToolTip(i18n("Show one page, or two pages side by side, per screen instead of scrolling."));
+    formLayout->addRow(QLatin1String(), pagedMode);
+
+    auto rightToLeft = new QCheckBox(this);
+    rightToLeft->setObjectName(QStringLiteral("kcfg_RightToLeft"));
+    rightToLeft->setText(i18n("Right to left"));
+    rightToLeft->setChecked(MangaReaderSettings::rightToLeft());
+    rightToLeft->setToolTip(i18n("Pages side by side are read from right to left,\n"
+                                 "in paged mode the left key goes to the next page."));
+    formLayout->addRow(QLatin1String(), rightToLeft);
+    // end paged mode
+
+
     // resize timer
     auto resizeTimer = new QCheckBox(this);
     resizeTimer->setObjectName(QStringLiteral("kcfg_UseResizeTimer"));
@@ -132,6 +150,121 @@ SettingsWindow::SettingsWindow(QWidget *parent, KConfigSkeleton *skeleton)
     // end max page width
 
 
+    // decode resolution
+    auto maxDecodePixelRatio = new QDoubleSpinBox(this);
+    maxDecodePixelRatio->setObjectName(QStringLiteral("kcfg_MaxDecodePixelRatio"));
+    maxDecodePixelRatio->setMinimum(0.5);
+    maxDecodePixelRatio->setMaximum(4.0);
+    maxDecodePixelRatio->setSingleStep(0.25);
+    maxDecodePixelRatio->setPrefix(i18n("×"));
+    maxDecodePixelRatio->setValue(MangaReaderSettings::maxDecodePixelRatio());
+    maxDecodePixelRatio->setToolTip(i18n("Pages are decoded at the screen's scale factor, up to this value.\n"
+                                         "Lower values use less memory, pages are then upscaled and less sharp."));
+    formLayout->addRow(i18n("Maximum decode scale"), maxDecodePixelRatio);
+    // end decode resolution
+
+
+    // page cache size
+    auto *pageCacheSize = new QSpinBox(this);
+    pageCacheSize->setObjectName(QStringLiteral("kcfg_PageCacheSize"));
+    pageCacheSize->setMinimum(0);
+    pageCacheSize->setMaximum(8192);
+    pageCacheSize->setSuffix(i18n(" MiB"));
+    pageCacheSize->setValue(MangaReaderSettings::pageCacheSize());
+    pageCacheSize->setToolTip(i18n("Memory used to keep decoded pages around,\n"
+                                   "zooming and resizing reuse them instead of decoding the pages again."));
+    formLayout->addRow(i18n("Decoded page cache"), pageCacheSize);
+
+    auto *compressedPageCacheSize = new QSpinBox(this);
+    compressedPageCacheSize->setObjectName(QStringLiteral("kcfg_CompressedPageCacheSize"));
+    compressedPageCacheSize->setMinimum(0);
+    compressedPageCacheSize->setMaximum(8192);
+    compressedPageCacheSize->setSuffix(i18n(" MiB"));
+    compressedPageCacheSize->setValue(MangaReaderSettings::compressedPageCacheSize());
+    compressedPageCacheSize->setToolTip(i18n("Memory used to keep pages pushed out of the decoded page cache, compressed.\n"
+                                             "Decompressing a page is much faster than decoding it again."));
+    formLayout->addRow(i18n("Compressed page cache"), compressedPageCacheSize);
+
+    auto leanPageMemory = new QCheckBox(this);
+    leanPageMemory->setObjectName(QStringLiteral("kcfg_LeanPageMemory"));
+    leanPageMemory->setText(i18n("Lean page memory"));
+    leanPageMemory->setChecked(MangaReaderSettings::leanPageMemory());
+    leanPageMemory->setToolTip(i18n("Displayed pages keep only the image shown on screen, about half the memory.\n"
+                                    "Resizing and copying pages get them from the page cache instead."));
+    formLayout->addRow(QLatin1String(), leanPageMemory);
+    // end page cache size
+
+
+    // disk cache
+    auto useDiskCache = new QCheckBox(this);
+    useDiskCache->setObjectName(QStringLiteral("kcfg_UseDiskCache"));
+    useDiskCache->setText(i18n("Keep scaled pages on disk"));
+    useDiskCache->setChecked(MangaReaderSettings::useDiskCache());
+    useDiskCache->setToolTip(i18n("Pages are saved already scaled, rereading at the same size\n"
+                                  "loads them without extracting and decoding."));
+    formLayout->addRow(QLatin1String(), useDiskCache);
+
+    auto diskCacheSize = new QSpinBox(this);
+    diskCacheSize->setObjectName(QStringLiteral("kcfg_DiskCacheSize"));
+    diskCacheSize->setMinimum(64);
+    diskCacheSize->setMaximum(65536);
+    diskCacheSize->setSuffix(i18n(" MiB"));
+    diskCacheSize->setValue(MangaReaderSettings::diskCacheSize());
+    diskCacheSize->setEnabled(MangaReaderSettings::useDiskCache());
+    diskCacheSize->setToolTip(i18n("When the limit is reached the least recently read pages are removed."));
+    connect(useDiskCache, &QCheckBox::checkStateChanged, this, [useDiskCache, diskCacheSize]() {
+        diskCacheSize->setEnabled(useDiskCache->isChecked());
+    });
+    formLayout->addRow(i18n("Disk cache size"), diskCacheSize);
+    // end disk cache
+
+
+    // library search
+    auto searchArchiveContents = new QCheckBox(this);
+    searchArchiveContents->setObjectName(QStringLiteral("kcfg_SearchArchiveContents"));
+    searchArchiveContents->setText(i18n("Search inside archives"));
+    searchArchiveContents->setChecked(MangaReaderSettings::searchArchiveContents());
+    searchArchiveContents->setToolTip(i18n("The library search also finds the file names and ComicInfo.xml titles inside the archives.\n"
+                                           "Every archive is opened once in the background, rar archives are skipped."));
+    formLayout->addRow(QLatin1String(), searchArchiveContents);
+    // end library search
+
+
+    // covers
+    auto showCovers = new QCheckBox(this);
+    showCovers->setObjectName(QStringLiteral("kcfg_ShowCovers"));
+    showCovers->setText(i18n("Show covers in the library"));
+    showCovers->setChecked(MangaReaderSettings::showCovers());
+    showCovers->setToolTip(i18n("The first image of archives and folders is shown as their icon.\n"
+                                "Covers are saved to the shared thumbnail cache, where file managers find them too."));
+    formLayout->addRow(QLatin1String(), showCovers);
+    // end covers
+
+
+    // load into memory
+    m_useMemExtraction = new QCheckBox(this);
+    m_useMemExtraction->setObjectName(QStringLiteral("kcfg_LoadIntoMemory"));
+    m_useMemExtraction->setText(i18n("Load manga into memory"));
+    m_useMemExtraction->setChecked(MangaReaderSettings::loadIntoMemory());
+    m_useMemExtraction->setToolTip(i18n("The whole archive or folder is read in one go when opened,\n"
+                                        "pages are then read from memory. Useful for slow and network drives."));
+    formLayout->addRow(QLatin1String(), m_useMemExtraction);
+
+    auto loadIntoMemoryMaxSize = new QSpinBox(this);
+    loadIntoMemoryMaxSize->setObjectName(QStringLiteral("kcfg_LoadIntoMemoryMaxSize"));
+    loadIntoMemoryMaxSize->setMinimum(16);
+    loadIntoMemoryMaxSize->setMaximum(16384);
+    loadIntoMemoryMaxSize->setSuffix(i18n(" MiB"));
+    loadIntoMemoryMaxSize->setValue(MangaReaderSettings::loadIntoMemoryMaxSize());
+    loadIntoMemoryMaxSize->setEnabled(MangaReaderSettings::loadIntoMemory());
+    loadIntoMemoryMaxSize->setToolTip(i18n("Bigger archives and folders are read from disk as usual."));
+    connect(m_useMemExtraction, &QCheckBox::checkStateChanged, this, [this, loadIntoMemoryMaxSize]() {
+        loadIntoMemoryMaxSize->setEnabled(m_useMemExtraction->isChecked());
+    });
+    formLayout->addRow(i18n("Load into memory up to"), loadIntoMemoryMaxSize);
+    // end load into memory
+
+
     // page spacing
     auto *hPageSpacing = new QSpinBox(this);
     hPageSpacing->setObjectName(QStringLiteral("kcfg_HPageSpacing"));
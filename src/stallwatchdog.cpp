@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "stallwatchdog.h"
+#include "trace.h"
+
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+
+#include <memory>
+
+using namespace Qt::StringLiterals;
+
+std::atomic<const char *> StallWatchdog::Detail::currentScope{nullptr};
+thread_local bool StallWatchdog::Detail::isWatchedThread{false};
+
+namespace
+{
+QElapsedTimer clock;
+// last time the watched event loop ran the heartbeat timer, in clock milliseconds
+std::atomic<qint64> lastBeat{0};
+std::unique_ptr<QTimer> heartbeat;
+std::unique_ptr<QThread> watcher;
+QMutex mutex;
+QWaitCondition stopCondition;
+bool stopRequested{false};
+
+void report(qint64 duration, const QStringList &scopes)
+{
+    const QString where = scopes.isEmpty() ? u"an uninstrumented scope"_s : scopes.join(u", "_s);
+    qWarning().noquote() << u"GUI thread stalled for %1 ms in %2"_s.arg(duration).arg(where);
+    if (Trace::isEnabled()) {
+        const qint64 end = Trace::now();
+        Trace::addSpan("stall", end - duration * 1000, end, -1, true);
+    }
+}
+
+void watch(int thresholdMsecs)
+{
+    // sample often enough to catch the scopes of short stalls
+    const int interval = qMax(thresholdMsecs / 4, 5);
+    qint64 stallStart{-1};
+    QStringList scopes;
+
+    QMutexLocker locker(&mutex);
+    while (!stopRequested) {
+        stopCondition.wait(&mutex, QDeadlineTimer(interval));
+
+        const qint64 beat = lastBeat.load(std::memory_order_relaxed);
+        // the heartbeat fires every `interval`, anything over that is time the loop didn't turn
+        if (clock.elapsed() - beat > thresholdMsecs + interval) {
+            if (stallStart < 0) {
+                stallStart = beat;
+                scopes.clear();
+            }
+            const char *scope = StallWatchdog::Detail::currentScope.load(std::memory_order_relaxed);
+            if (scope && !scopes.contains(QLatin1StringView(scope))) {
+                scopes.append(QString::fromLatin1(scope));
+            }
+        } else if (stallStart >= 0) {
+            report(beat - stallStart - interval, scopes);
+            stallStart = -1;
+        }
+    }
+}
+}
+
+void StallWatchdog::start(int thresholdMsecs)
+{
+    if (thresholdMsecs <= 0 || watcher) {
+        return;
+    }
+    Detail::isWatchedThread = true;
+    clock.start();
+    lastBeat = 0;
+
+    const int interval = qMax(thresholdMsecs / 4, 5);
+    heartbeat = std::make_unique<QTimer>();
+    heartbeat->setInterval(interval);
+    QObject::connect(heartbeat.get(), &QTimer::timeout, []() {
+        lastBeat.store(clock.elapsed(), std::memory_order_relaxed);
+    });
+    heartbeat->start();
+
+    stopRequested = false;
+    watcher.reset(QThread::create(watch, thresholdMsecs));
+    watcher->setObjectName(u"stall watchdog"_s);
+    watcher->start(QThread::HighPriority);
+}
+
+void StallWatchdog::stop()
+{
+    if (!watcher) {
+        return;
+    }
+    {
+        QMutexLocker locker(&mutex);
+        stopRequested = true;
+        stopCondition.wakeAll();
+    }
+    watcher->wait();
+    watcher.reset();
+    heartbeat.reset();
+    Detail::isWatchedThread = false;
+}
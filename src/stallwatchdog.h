@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/**
+ * Watches the thread it is started on from a background thread and logs
+ * every time its event loop doesn't turn for longer than a threshold,
+ * with the instrumented scopes that were running during the stall.
+ * Stalls are also added to the trace when tracing is on.
+ */
+namespace StallWatchdog
+{
+namespace Detail
+{
+// innermost scope running on the watched thread
+extern std::atomic<const char *> currentScope;
+extern thread_local bool isWatchedThread;
+}
+
+/**
+ * Must be called from the thread with the event loop to watch
+ */
+void start(int thresholdMsecs);
+void stop();
+
+class Scope
+{
+public:
+    explicit Scope(const char *name)
+        : m_active{Detail::isWatchedThread}
+    {
+        if (m_active) {
+            m_previous = Detail::currentScope.exchange(name, std::memory_order_relaxed);
+        }
+    }
+
+    ~Scope()
+    {
+        if (m_active) {
+            Detail::currentScope.store(m_previous, std::memory_order_relaxed);
+        }
+    }
+
+    Q_DISABLE_COPY_MOVE(Scope)
+
+private:
+    bool m_active;
+    const char *m_previous{nullptr};
+};
+}
+
+#define STALL_CONCAT_IMPL(a, b) a##b
+#define STALL_CONCAT(a, b) STALL_CONCAT_IMPL(a, b)
+/**
+ * Names the rest of the enclosing scope in stall reports, `name` must be a string literal
+ */
+#define STALL_SCOPE(name) const StallWatchdog::Scope STALL_CONCAT(stallScope, __LINE__)(name)
+
+#endif // STALLWATCHDOG_H
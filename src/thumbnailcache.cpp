@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "thumbnailcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimeZone>
+#include <QUrl>
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr int LargeSize{256};
+// the spec wants a folder per program and version, a new version tries the failed files again
+constexpr auto FailFolder{"mangareader-1"};
+
+qint64 modified(const QString &path)
+{
+    return QFileInfo(path).lastModified(QTimeZone::UTC).toSecsSinceEpoch();
+}
+
+bool makeDirectory(const QString &path)
+{
+    // thumbnails show what the user's files contain, only the user can read them
+    if (!QDir().mkpath(path)) {
+        return false;
+    }
+    return QFile::setPermissions(path, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+}
+}
+
+ThumbnailCache::ThumbnailCache(const QString &directory, const QString &failDirectory)
+    : m_directory{directory}
+    , m_failDirectory{failDirectory}
+{
+}
+
+ThumbnailCache ThumbnailCache::shared()
+{
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + u"/thumbnails"_s;
+    return ThumbnailCache(directory, directory + u"/fail/"_s + QLatin1String(FailFolder));
+}
+
+ThumbnailCache ThumbnailCache::folderCovers()
+{
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/covers"_s;
+    return ThumbnailCache(directory, directory + u"/fail"_s);
+}
+
+int ThumbnailCache::size()
+{
+    return LargeSize;
+}
+
+QImage ThumbnailCache::find(const QString &path) const
+{
+    const QImage thumbnail(m_directory + u"/large/"_s + fileName(path));
+    if (!isValid(thumbnail, uri(path), modified(path))) {
+        return {};
+    }
+    return thumbnail;
+}
+
+bool ThumbnailCache::insert(const QString &path, const QImage &image) const
+{
+    if (image.isNull()) {
+        return false;
+    }
+    QImage thumbnail = image.width() > LargeSize || image.height() > LargeSize
+        ? image.scaled(LargeSize, LargeSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+        : image;
+    thumbnail.setText(u"Thumb::URI"_s, uri(path));
+    thumbnail.setText(u"Thumb::MTime"_s, QString::number(modified(path)));
+    thumbnail.setText(u"Thumb::Size"_s, QString::number(QFileInfo(path).size()));
+    thumbnail.setText(u"Software"_s, u"mangareader"_s);
+    return save(thumbnail, m_directory + u"/large/"_s + fileName(path));
+}
+
+bool ThumbnailCache::hasFailed(const QString &path) const
+{
+    const QImage failure(m_failDirectory + u'/' + fileName(path));
+    return isValid(failure, uri(path), modified(path));
+}
+
+void ThumbnailCache::insertFailure(const QString &path) const
+{
+    // the spec's failure marker, an empty png carrying the uri and time
+    QImage failure(1, 1, QImage::Format_ARGB32);
+    failure.fill(Qt::transparent);
+    failure.setText(u"Thumb::URI"_s, uri(path));
+    failure.setText(u"Thumb::MTime"_s, QString::number(modified(path)));
+    save(failure, m_failDirectory + u'/' + fileName(path));
+}
+
+QString ThumbnailCache::uri(const QString &path)
+{
+    return QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded);
+}
+
+QString ThumbnailCache::fileName(const QString &path)
+{
+    const QByteArray hash = QCryptographicHash::hash(uri(path).toUtf8(), QCryptographicHash::Md5);
+    return QString::fromLatin1(hash.toHex()) + u".png"_s;
+}
+
+bool ThumbnailCache::isValid(const QImage &thumbnail, const QString &uri, qint64 modified)
+{
+    return !thumbnail.isNull() && thumbnail.text(u"Thumb::URI"_s) == uri
+        && thumbnail.text(u"Thumb::MTime"_s).toLongLong() == modified;
+}
+
+bool ThumbnailCache::save(const QImage &thumbnail, const QString &path)
+{
+    if (!makeDirectory(QFileInfo(path).path())) {
+        return false;
+    }
+    // written to a temporary file and renamed, readers never see half a thumbnail
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || !thumbnail.save(&file, "PNG") || !file.commit()) {
+        return false;
+    }
+    return QFile::setPermissions(path, QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+}
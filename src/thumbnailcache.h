@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QImage>
+#include <QString>
+
+/**
+ * Thumbnails saved the way the freedesktop.org thumbnail spec describes:
+ * png files named after the md5 of the file's uri, with the uri and
+ * modification time of the file stored in the png, so a changed file
+ * isn't shown with an old thumbnail.
+ *
+ * Archive thumbnails go to the shared folder, where file managers find them
+ * and the reader finds theirs. Folders are not covered by the spec,
+ * their covers are kept in the reader's own cache folder in the same format.
+ */
+class ThumbnailCache
+{
+public:
+    /**
+     * `directory` holds one folder per thumbnail size, `failDirectory`
+     * the files the thumbnails couldn't be made for
+     */
+    ThumbnailCache(const QString &directory, const QString &failDirectory);
+
+    /**
+     * $XDG_CACHE_HOME/thumbnails
+     */
+    static ThumbnailCache shared();
+    static ThumbnailCache folderCovers();
+
+    /**
+     * 256, the size of the spec's "large" thumbnails
+     */
+    static int size();
+
+    /**
+     * A null image when there is no thumbnail for `path` or the file changed since it was made
+     */
+    QImage find(const QString &path) const;
+    bool insert(const QString &path, const QImage &image) const;
+
+    /**
+     * Whether making the thumbnail failed for `path` as it is now
+     */
+    bool hasFailed(const QString &path) const;
+    void insertFailure(const QString &path) const;
+
+    static QString uri(const QString &path);
+    static QString fileName(const QString &path);
+
+private:
+    static bool isValid(const QImage &thumbnail, const QString &uri, qint64 modified);
+    static bool save(const QImage &thumbnail, const QString &path);
+
+    QString m_directory;
+    QString m_failDirectory;
+};
+
+#endif // THUMBNAILCACHE_H
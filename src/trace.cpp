@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+
+#include <vector>
+
+using namespace Qt::StringLiterals;
+
+std::atomic_bool Trace::Detail::enabled{false};
+
+namespace
+{
+struct Event {
+    const char *name;
+    qint64 start;
+    qint64 end;
+    int pageNumber;
+    int threadId;
+    bool async;
+};
+
+QMutex mutex;
+QElapsedTimer clock;
+QString outputPath;
+std::vector<Event> events;
+QHash<int, QString> threadNames;
+std::atomic_int nextThreadId{1};
+std::atomic_int nextAsyncId{1};
+
+// small sequential ids read better in the viewer than native thread handles
+int currentThreadId()
+{
+    thread_local int id{0};
+    if (id == 0) {
+        id = nextThreadId++;
+        QThread *thread = QThread::currentThread();
+        QString name = thread->objectName();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+            name = u"gui"_s;
+        } else if (name.isEmpty()) {
+            name = u"thread %1"_s.arg(id);
+        }
+        QMutexLocker locker(&mutex);
+        threadNames.insert(id, name);
+    }
+    return id;
+}
+
+QJsonObject eventObject(const Event &event, const char *phase, qint64 timestamp)
+{
+    QJsonObject object{
+        {u"name"_s, QString::fromLatin1(event.name)},
+        {u"ph"_s, QString::fromLatin1(phase)},
+        {u"ts"_s, timestamp},
+        {u"pid"_s, 1},
+        {u"tid"_s, event.threadId},
+    };
+    if (event.pageNumber >= 0) {
+        object.insert(u"args"_s, QJsonObject{{u"page"_s, event.pageNumber}});
+    }
+    return object;
+}
+}
+
+bool Trace::start(const QString &path)
+{
+    QMutexLocker locker(&mutex);
+    if (path.isEmpty() || isEnabled()) {
+        return false;
+    }
+    outputPath = path;
+    events.clear();
+    events.reserve(64 * 1024);
+    clock.start();
+    Detail::enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void Trace::stop()
+{
+    if (!isEnabled()) {
+        return;
+    }
+    Detail::enabled.store(false, std::memory_order_relaxed);
+
+    QMutexLocker locker(&mutex);
+    QJsonArray traceEvents;
+    for (auto it = threadNames.cbegin(); it != threadNames.cend(); ++it) {
+        traceEvents.append(QJsonObject{
+            {u"name"_s, u"thread_name"_s},
+            {u"ph"_s, u"M"_s},
+            {u"pid"_s, 1},
+            {u"tid"_s, it.key()},
+            {u"args"_s, QJsonObject{{u"name"_s, it.value()}}},
+        });
+    }
+    for (const Event &event : events) {
+        if (!event.async) {
+            QJsonObject object = eventObject(event, "X", event.start);
+            object.insert(u"dur"_s, event.end - event.start);
+            traceEvents.append(object);
+            continue;
+        }
+        // async begin and end are matched by category and id
+        const int id = nextAsyncId++;
+        QJsonObject begin = eventObject(event, "b", event.start);
+        QJsonObject end = eventObject(event, "e", event.end);
+        for (QJsonObject *object : {&begin, &end}) {
+            object->insert(u"cat"_s, u"request"_s);
+            object->insert(u"id"_s, id);
+        }
+        traceEvents.append(begin);
+        traceEvents.append(end);
+    }
+    events.clear();
+
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write trace" << outputPath << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(QJsonObject{{u"traceEvents"_s, traceEvents}, {u"displayTimeUnit"_s, u"ms"_s}}).toJson(QJsonDocument::Compact));
+}
+
+qint64 Trace::now()
+{
+    return clock.nsecsElapsed() / 1000;
+}
+
+void Trace::addSpan(const char *name, qint64 start, qint64 end, int pageNumber, bool async)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    const int threadId = currentThreadId();
+    QMutexLocker locker(&mutex);
+    events.push_back({name, start, end, pageNumber, threadId, async});
+}
@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: 2026 George Florea Bănuș <georgefb899@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+
+#include <atomic>
+
+/**
+ * Records timed spans and writes them as Chrome trace-event JSON,
+ * viewable in about://tracing or ui.perfetto.dev.
+ * When not started a span costs a single relaxed atomic load.
+ */
+namespace Trace
+{
+namespace Detail
+{
+extern std::atomic_bool enabled;
+}
+
+inline bool isEnabled()
+{
+    return Detail::enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Starts recording, the events are written to `path` by stop()
+ */
+bool start(const QString &path);
+void stop();
+
+/**
+ * Microseconds since start()
+ */
+qint64 now();
+
+/**
+ * `name` must outlive the trace, use string literals.
+ * Spans on one thread have to nest, `async` spans can overlap
+ * and can end on a different thread than they started on.
+ */
+void addSpan(const char *name, qint64 start, qint64 end, int pageNumber = -1, bool async = false);
+
+class Span
+{
+public:
+    explicit Span(const char *name, int pageNumber = -1)
+        : m_name{name}
+        , m_pageNumber{pageNumber}
+        , m_start{isEnabled() ? now() : -1}
+    {
+    }
+
+    ~Span()
+    {
+        if (m_start >= 0) {
+            addSpan(m_name, m_start, now(), m_pageNumber);
+        }
+    }
+
+    Q_DISABLE_COPY_MOVE(Span)
+
+private:
+    const char *m_name;
+    int m_pageNumber;
+    qint64 m_start;
+};
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+/**
+ * Times the rest of the enclosing scope
+ */
+#define TRACE_SCOPE(name, pageNumber) const Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name, pageNumber)
+
+#endif // TRACE_H
@@ -12,10 +12,14 @@
 #include <QClipboard>
 #include <QFile>
 #include <QFileInfo>
+#include <QGraphicsPixmapItem>
+#include <QFontDatabase>
 #include <QImageReader>
+#include <QLabel>
 #include <QMenu>
 #include <QMimeData>
 #include <QMouseEvent>
+#include <QPainter>
 #include <QPropertyAnimation>
 #include <QScrollBar>
 #include <QTimer>
@@ -24,10 +28,16 @@
 #include <KLocalizedString>
 #include <KXMLGUIFactory>
 
+#include "diskcache.h"
 #include "imagerequest.h"
 #include "mainwindow.h"
 #include "page.h"
 #include "settings.h"
+#include "stallwatchdog.h"
+#include "trace.h"
+
+// frames composited ahead of time on each side of the current one in paged mode
+static constexpr int PrefetchFrames{2};
 
 View::View(MainWindow *parent)
     : QGraphicsView{ parent }
@@ -36,6 +46,10 @@ View::View(MainWindow *parent)
     m_scrollAnimation = new QPropertyAnimation(vBar, "value", this);
     m_scrollAnimation->setEasingCurve(QEasingCurve::OutCubic);
     m_scrollAnimation->setDuration(150);
+    connect(m_scrollAnimation, &QAbstractAnimation::stateChanged, this, [this]() {
+        // frame times are only measured within one animation
+        m_lastFrameTime = -1;
+    });
 
     KXMLGUIClient::setComponentName(QStringLiteral("mangareader"), i18n("View"));
     setXMLFile(QStringLiteral("viewui.rc"));
@@ -48,8 +62,18 @@ View::View(MainWindow *parent)
             p->redrawImage();
         }
         calculatePageSizes();
+        setPagesVisibility();
     });
 
+    m_hud = new QLabel(this);
+    m_hud->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_hud->setStyleSheet(u"QLabel { background-color: rgba(0, 0, 0, 180); color: white; padding: 6px; }"_s);
+    m_hud->setAttribute(Qt::WA_TransparentForMouseEvents);
+    m_hud->hide();
+    m_hudTimer = new QTimer(this);
+    m_hudTimer->setInterval(500);
+    connect(m_hudTimer, &QTimer::timeout, this, &View::updateHud);
+
     setupActions();
     parent->guiFactory()->addClient(this);
 
@@ -69,13 +93,29 @@ View::View(MainWindow *parent)
     m_scene = new QGraphicsScene(this);
     setScene(m_scene);
 
+    // shows the composited frame in paged mode, above the pages it was made from
+    m_frameItem = new QGraphicsPixmapItem();
+    m_frameItem->setZValue(1);
+    m_frameItem->hide();
+    m_scene->addItem(m_frameItem);
+    setVerticalScrollBarPolicy(isPaged() ? Qt::ScrollBarAlwaysOff : Qt::ScrollBarAsNeeded);
+
     connect(MangaReaderSettings::self(), &MangaReaderSettings::Show2PagesPerRowChanged, this, [this]() {
         calculatePageSizes();
     });
 
     connect(verticalScrollBar(), &QScrollBar::rangeChanged,
             this, &View::onScrollBarRangeChanged);
-    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+    m_scrollClock.start();
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        m_prefetchWindow.addScrollSample(m_scrollClock.elapsed(), value);
+        if (isPaged()) {
+            setPagesVisibility();
+            if (m_currentFrame < m_frames.size()) {
+                Q_EMIT currentImageChanged(m_frames.at(m_currentFrame).constFirst());
+            }
+            return;
+        }
         auto hSpacing = MangaReaderSettings::hPageSpacing();
         QPoint topCenter = QPoint(m_scene->width()/2 + hSpacing, 1);
         Page *p = qgraphicsitem_cast<Page *>(itemAt(topCenter));
@@ -135,6 +175,10 @@ void View::setupActions()
     auto scrollUpOneScreen = new QAction(i18n("Scroll Up One Screen"));
     scrollUpOneScreen->setShortcutContext(Qt::WidgetShortcut);
     connect(scrollUpOneScreen, &QAction::triggered, this, [this]() {
+        if (isPaged()) {
+            showFrame(m_currentFrame - 1);
+            return;
+        }
         verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepSub);
     });
     collection->setDefaultShortcuts(scrollUpOneScreen, {Qt::Key_PageUp, Qt::SHIFT | Qt::Key_Space});
@@ -143,6 +187,10 @@ void View::setupActions()
     auto scrollDownOneScreen = new QAction(i18n("Scroll Down One Screen"));
     scrollDownOneScreen->setShortcutContext(Qt::WidgetShortcut);
     connect(scrollDownOneScreen, &QAction::triggered, this, [this]() {
+        if (isPaged()) {
+            showFrame(m_currentFrame + 1);
+            return;
+        }
         verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepAdd);
     });
     collection->setDefaultShortcuts(scrollDownOneScreen, {Qt::Key_PageDown, Qt::Key_Space});
@@ -151,6 +199,11 @@ void View::setupActions()
     auto nextPage = new QAction(i18n("Next Page"));
     nextPage->setShortcutContext(Qt::WidgetShortcut);
     connect(nextPage, &QAction::triggered, this, [this]() {
+        if (isPaged()) {
+            // the right key always goes to the page on the right
+            showFrame(m_currentFrame + (MangaReaderSettings::rightToLeft() ? -1 : 1));
+            return;
+        }
         int step = MangaReaderSettings::show2PagesPerRow() ? 2 : 1;
         if (m_firstVisible < m_pages.count() - step) {
             goToPage(m_firstVisible + step);
@@ -162,6 +215,10 @@ void View::setupActions()
     auto prevPage = new QAction(i18n("Previous Page"));
     prevPage->setShortcutContext(Qt::WidgetShortcut);
     connect(prevPage, &QAction::triggered, this, [this]() {
+        if (isPaged()) {
+            showFrame(m_currentFrame + (MangaReaderSettings::rightToLeft() ? 1 : -1));
+            return;
+        }
         int step = MangaReaderSettings::show2PagesPerRow() ? 2 : 1;
         if (m_firstVisible >= step) {
             goToPage(m_firstVisible - step);
@@ -169,26 +226,47 @@ void View::setupActions()
     });
     collection->setDefaultShortcut(prevPage, Qt::Key_Left);
     collection->addAction(u"prevPage"_s, prevPage);
+
+    auto toggleHud = new QAction(i18n("Show Performance Overlay"));
+    toggleHud->setCheckable(true);
+    toggleHud->setShortcutContext(Qt::WidgetShortcut);
+    connect(toggleHud, &QAction::toggled, this, &View::setHudVisible);
+    collection->setDefaultShortcut(toggleHud, Qt::Key_F12);
+    collection->addAction(u"toggleHud"_s, toggleHud);
 }
 
 void View::reset()
 {
+    STALL_SCOPE("View::reset");
     qDeleteAll(m_pages);
     m_pages.clear();
     m_start.clear();
     m_end.clear();
     m_requestedPages.clear();
+    m_visibleRequestTimes.clear();
     m_files.clear();
+    m_frames.clear();
+    m_pageFrames.clear();
+    m_composedFrames.clear();
+    m_currentFrame = 0;
+    m_pagedWheelDelta = 0;
+    m_hiddenPages.clear();
+    m_frameItem->hide();
+    m_frameItem->setPixmap({});
     verticalScrollBar()->setValue(0);
 }
 
 void View::openManga(const QString &path, bool recursive)
 {
     if (m_manga) {
-        m_manga->cancelArchiveProcessing();
+        // the old manga finishes in the background and deletes itself,
+        // switching quickly between big archives doesn't block the ui
+        m_manga->disconnect(this);
+        m_manga.release()->abandon();
     }
     m_manga = std::make_unique<Manga>(path);
     m_manga->setOpenFolderRecursive(recursive);
+    applyMangaSettings();
 
     connect(m_manga.get(), &Manga::imagesReady, this, [this]() {
         reset();
@@ -202,12 +280,30 @@ void View::openManga(const QString &path, bool recursive)
     connect(m_manga.get(), &Manga::imageReady,
             this, &View::onImageReady, Qt::QueuedConnection);
 
+    connect(m_manga.get(), &Manga::tileReady,
+            this, &View::onTileReady, Qt::QueuedConnection);
+
+    connect(m_manga.get(), &Manga::previewReady,
+            this, &View::onPreviewReady, Qt::QueuedConnection);
+
     connect(m_manga.get(), &Manga::extractionProgress,
             this, &View::mangaExtractionProgress);
 
     m_manga->init();
 }
 
+void View::applyMangaSettings()
+{
+    m_manga->setPageCacheSize(static_cast<qint64>(MangaReaderSettings::pageCacheSize()) * 1024 * 1024);
+    m_manga->setCompressedPageCacheSize(static_cast<qint64>(MangaReaderSettings::compressedPageCacheSize()) * 1024 * 1024);
+    m_manga->setDiskCacheEnabled(MangaReaderSettings::useDiskCache());
+    DiskCache::self()->setMaxSize(static_cast<qint64>(MangaReaderSettings::diskCacheSize()) * 1024 * 1024);
+    m_manga->setLoadIntoMemory(m_loadFromMemory, static_cast<qint64>(MangaReaderSettings::loadIntoMemoryMaxSize()) * 1024 * 1024);
+    m_manga->setUnrarPath(MangaReaderSettings::unrarPath().isEmpty()
+                          ? MangaReaderSettings::autoUnrarPath()
+                          : MangaReaderSettings::unrarPath());
+}
+
 void View::loadImages()
 {
     createPages();
@@ -217,6 +313,7 @@ void View::loadImages()
 
 void View::createPages()
 {
+    STALL_SCOPE("View::createPages");
     QFileInfo fi;
     QScopedPointer<QIODevice> dev;
     QImageReader imageReader;
@@ -239,6 +336,16 @@ void View::createPages()
 
 void View::calculatePageSizes()
 {
+    TRACE_SCOPE("layout", -1);
+    STALL_SCOPE("View::calculatePageSizes");
+    // layout changed, composited frames no longer match the pages
+    m_composedFrames.clear();
+    updateFrameItem();
+    if (isPaged()) {
+        calculatePagedLayout();
+        return;
+    }
+
     int pageYCoordinate = 0;
     const int hSpacing = MangaReaderSettings::hPageSpacing();
     const int vSpacing = MangaReaderSettings::vPageSpacing();
@@ -255,15 +362,19 @@ void View::calculatePageSizes()
             int totalWidth = p1->scaledSize().width() + p2->scaledSize().width() + hSpacing;
             int startX = (viewportWidth - totalWidth) / 2;
 
-            p1->setPos(startX, pageYCoordinate);
-            p1->setRect({p1->x(), p1->y(),
-                         static_cast<qreal>(p1->scaledSize().width()),
-                         static_cast<qreal>(p1->scaledSize().height())});
+            // right to left, the first page of the row is on the right
+            const auto &left = MangaReaderSettings::rightToLeft() ? p2 : p1;
+            const auto &right = MangaReaderSettings::rightToLeft() ? p1 : p2;
+
+            left->setPos(startX, pageYCoordinate);
+            left->setRect({left->x(), left->y(),
+                           static_cast<qreal>(left->scaledSize().width()),
+                           static_cast<qreal>(left->scaledSize().height())});
 
-            p2->setPos(startX + p1->scaledSize().width() + hSpacing, pageYCoordinate);
-            p2->setRect({p2->x(), p2->y(),
-                         static_cast<qreal>(p2->scaledSize().width()),
-                         static_cast<qreal>(p2->scaledSize().height())});
+            right->setPos(startX + left->scaledSize().width() + hSpacing, pageYCoordinate);
+            right->setRect({right->x(), right->y(),
+                            static_cast<qreal>(right->scaledSize().width()),
+                            static_cast<qreal>(right->scaledSize().height())});
 
             int maxHeight = std::max(p1->scaledSize().height(), p2->scaledSize().height());
 
@@ -293,9 +404,161 @@ void View::calculatePageSizes()
     m_scene->setSceneRect(m_scene->itemsBoundingRect());
 }
 
+bool View::isPaged() const
+{
+    return MangaReaderSettings::pagedMode();
+}
+
+void View::calculatePagedLayout()
+{
+    const int hSpacing = MangaReaderSettings::hPageSpacing();
+    const bool rightToLeft = MangaReaderSettings::rightToLeft();
+    const int viewportWidth = viewport()->width();
+    const int viewportHeight = viewport()->height();
+
+    m_frames.clear();
+    m_pageFrames.resize(m_pages.size());
+    for (int i = 0; i < m_pages.count(); ++i) {
+        QList<int> frame{i};
+        if (MangaReaderSettings::show2PagesPerRow() && i + 1 < m_pages.count()) {
+            frame.append(++i);
+        }
+        m_frames.append(frame);
+    }
+
+    // every frame takes exactly one screen, stacked like the pages in continuous mode
+    for (int f = 0; f < m_frames.size(); ++f) {
+        const QList<int> &frame = m_frames.at(f);
+        const int frameY = f * viewportHeight;
+
+        int totalWidth = hSpacing * (frame.size() - 1);
+        for (int number : frame) {
+            m_pages.at(number)->calculateScaledSize();
+            totalWidth += m_pages.at(number)->scaledSize().width();
+            m_pageFrames[number] = f;
+        }
+
+        int x = (viewportWidth - totalWidth) / 2;
+        for (int i = 0; i < frame.size(); ++i) {
+            const int number = frame.at(rightToLeft ? frame.size() - 1 - i : i);
+            Page *page = m_pages.at(number);
+            const QSize size = page->scaledSize();
+            page->setPos(x, frameY + (viewportHeight - size.height()) / 2);
+            page->setRect({page->x(), page->y(), static_cast<qreal>(size.width()), static_cast<qreal>(size.height())});
+            m_start[number] = frameY;
+            m_end[number] = frameY + viewportHeight;
+            x += size.width() + hSpacing;
+        }
+    }
+    m_scene->setSceneRect(0, 0, viewportWidth, static_cast<qreal>(m_frames.size()) * viewportHeight);
+}
+
+void View::showFrame(int frame)
+{
+    if (m_frames.isEmpty()) {
+        return;
+    }
+    const int previousFrame = m_currentFrame;
+    m_currentFrame = qBound(0, frame, static_cast<int>(m_frames.size()) - 1);
+    if (m_currentFrame != previousFrame) {
+        m_pagedWheelDelta = 0;
+    }
+    verticalScrollBar()->setValue(m_currentFrame * viewport()->height());
+    updateFrameItem();
+}
+
+void View::composeFrame(int frame)
+{
+    if (frame < 0 || frame >= m_frames.size() || m_composedFrames.contains(frame)) {
+        return;
+    }
+    TRACE_SCOPE("composeFrame", -1);
+    STALL_SCOPE("View::composeFrame");
+
+    const QList<int> &numbers = m_frames.at(frame);
+    for (int number : numbers) {
+        const Page *page = m_pages.at(number);
+        if (page->isTiled() || page->isImageDeleted() || page->isImageOutdated()) {
+            return;
+        }
+    }
+
+    // the frame is drawn once, flipping to it only swaps the pixmap shown
+    const qreal dpr = devicePixelRatioF();
+    const QRectF frameRect(0, static_cast<qreal>(frame) * viewport()->height(), viewport()->width(), viewport()->height());
+    QPixmap pixmap((frameRect.size() * dpr).toSize());
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setPen(QPen(MangaReaderSettings::borderColor(), 1));
+    for (int number : numbers) {
+        const Page *page = m_pages.at(number);
+        const QRectF target = page->rect().translated(-frameRect.topLeft());
+        painter.drawRect(target.adjusted(-0.5, -0.5, 0.5, 0.5));
+        painter.drawPixmap(target, page->pixmap(), QRectF(page->pixmap().rect()));
+    }
+    painter.end();
+
+    m_composedFrames.insert(frame, pixmap);
+}
+
+void View::updateFrameItem()
+{
+    const bool show = isPaged() && m_composedFrames.contains(m_currentFrame);
+
+    // the pages under the frame don't need to be painted
+    for (int number : std::as_const(m_hiddenPages)) {
+        if (number < m_pages.size()) {
+            m_pages.at(number)->show();
+        }
+    }
+    m_hiddenPages.clear();
+
+    if (!show) {
+        m_frameItem->hide();
+        m_frameItem->setPixmap({});
+        return;
+    }
+
+    m_frameItem->setPixmap(m_composedFrames.value(m_currentFrame));
+    m_frameItem->setPos(0, static_cast<qreal>(m_currentFrame) * viewport()->height());
+    m_frameItem->show();
+    m_hiddenPages = m_frames.at(m_currentFrame);
+    for (int number : std::as_const(m_hiddenPages)) {
+        m_pages.at(number)->hide();
+    }
+}
+
+Page *View::pageAt(const QPoint &position) const
+{
+    if (!isPaged()) {
+        return qgraphicsitem_cast<Page *>(itemAt(position));
+    }
+
+    // the pages of the current frame are hidden under the composited frame
+    const QPointF scenePosition = mapToScene(position);
+    if (m_currentFrame < m_frames.size()) {
+        for (int number : m_frames.at(m_currentFrame)) {
+            if (m_pages.at(number)->rect().contains(scenePosition)) {
+                return m_pages.at(number);
+            }
+        }
+    }
+    return nullptr;
+}
+
 void View::setPagesVisibility()
 {
-    QList<ImageRequest *> requestedImages;
+    if (!m_manga) {
+        return;
+    }
+    TRACE_SCOPE("visibility", -1);
+    STALL_SCOPE("View::setPagesVisibility");
+
+    std::vector<std::unique_ptr<ImageRequest>> requestedImages;
+    std::vector<std::unique_ptr<ImageRequest>> requestedPreviews;
     QList<Page *> visiblePages;
 
     m_firstVisible = -1;
@@ -306,15 +569,49 @@ void View::setPagesVisibility()
                               viewport()->width(),
                               viewport()->height());
     // use a bigger rect than the viewport's rect to check if the page is in view
-    // this way pages just outside the actual viewport are also loaded
+    // this way pages just outside the actual viewport are also loaded,
+    // how far depends on the scroll speed and how fast pages are decoded
+    const qreal pendingScroll = m_scrollAnimation->state() == QAbstractAnimation::Running
+        ? m_targetScrollValue - verticalScrollBar()->value()
+        : 0;
+    // the pixmaps kept around the viewport should fit in the page cache budget
+    const qreal bytesPerRow = qMax(viewport()->width(), 1) * 4.0 * decodePixelRatio() * decodePixelRatio();
+    const qreal maxExtent = qMax(MangaReaderSettings::pageCacheSize() * 1024.0 * 1024.0 / bytesPerRow,
+                                 viewport()->height() * 3.0);
+    const qreal pageHeight = m_pages.isEmpty() ? 0 : m_scene->height() / m_pages.size();
+    m_prefetchWindow.setDecodeTime(m_manga->averageDecodeTime());
+    PrefetchWindow::Band band = m_prefetchWindow.band(m_scrollClock.elapsed(),
+                                                      viewport()->height(),
+                                                      pageHeight,
+                                                      pendingScroll,
+                                                      maxExtent);
+    if (isPaged() && !m_frames.isEmpty()) {
+        // the frames around the current one are decoded ahead, whatever the direction
+        m_currentFrame = qBound(0, verticalScrollBar()->value() / qMax(viewport()->height(), 1), static_cast<int>(m_frames.size()) - 1);
+        band = {PrefetchFrames * viewport()->height() * 1.0, PrefetchFrames * viewport()->height() * 1.0};
+    }
+    if (pageHeight > 0 && m_manga->usesScrollState()) {
+        // pages per second for the schedulers, the prefetch window works in pixels per millisecond
+        const qreal centerY = viewportRect.center().y();
+        qreal position = centerY / pageHeight;
+        for (Page *page : std::as_const(m_pages)) {
+            const QRectF rect = page->rect();
+            if (rect.top() <= centerY && centerY < rect.bottom()) {
+                position = page->number() + (centerY - rect.top()) / rect.height();
+                break;
+            }
+        }
+        m_manga->setScrollState({position, m_prefetchWindow.velocity(m_scrollClock.elapsed()) * 1000.0 / pageHeight});
+    }
     const QRectF customViewportRect(horizontalScrollBar()->value(),
-                                    verticalScrollBar()->value() - viewport()->height(),
+                                    verticalScrollBar()->value() - band.before,
                                     viewport()->width(),
-                                    viewport()->height() * 3);
+                                    viewport()->height() + band.before + band.after);
     for (const auto &page : std::as_const(m_pages)) {
         QRectF intersectionRect = customViewportRect.intersected(page->rect());
         if (intersectionRect.isEmpty()) {
             page->deleteImage();
+            m_visibleRequestTimes.remove(page->number());
             continue;
         }
 
@@ -329,16 +626,68 @@ void View::setPagesVisibility()
 
         visiblePages.append(page);
 
-        if (page->isImageDeleted()) {
-            ImageRequest *ir = new ImageRequest();
+        if (page->isTiled()) {
+            // only decode the tiles inside the prefetch area
+            const QList<int> tiles = page->tilesIntersecting(intersectionRect.translated(-page->pos()));
+            page->keepTiles(tiles);
+            for (int tile : tiles) {
+                if (page->hasTile(tile)) {
+                    continue;
+                }
+                auto ir = std::make_unique<ImageRequest>();
+                ir->pageNumber = page->number();
+                ir->path = page->filename();
+                ir->tile = tile;
+                ir->size = page->tileDecodeSize(tile);
+                ir->sourceRect = page->tileSourceRect(tile);
+                requestedImages.push_back(std::move(ir));
+            }
+            continue;
+        }
+
+        if (page->isImageDeleted() || page->isImageOutdated()) {
+            if (viewportRect.intersects(page->rect()) && !m_visibleRequestTimes.contains(page->number())) {
+                m_visibleRequestTimes.insert(page->number(), m_scrollClock.elapsed());
+            }
+            auto ir = std::make_unique<ImageRequest>();
             ir->pageNumber = page->number();
             ir->path = page->filename();
-            ir->size = page->scaledSize();
-            requestedImages.append(ir);
+            ir->size = page->decodeSize();
+
+            if (page->isImageDeleted() && !page->hasPreview()) {
+                auto preview = std::make_unique<ImageRequest>();
+                preview->pageNumber = ir->pageNumber;
+                preview->path = ir->path;
+                preview->size = ir->size;
+                preview->preview = true;
+                requestedPreviews.push_back(std::move(preview));
+            }
+            requestedImages.push_back(std::move(ir));
         }
     }
 
-    m_manga->addRequests(requestedImages);
+    if (isPaged() && !m_frames.isEmpty()) {
+        // requests are taken from the back, the current frame goes first
+        auto distance = [this](const std::unique_ptr<ImageRequest> &request) {
+            return qAbs(m_pageFrames.at(request->pageNumber) - m_currentFrame);
+        };
+        std::stable_sort(requestedImages.begin(), requestedImages.end(), [&distance](const auto &a, const auto &b) {
+            return distance(a) > distance(b);
+        });
+
+        m_composedFrames.removeIf([this](QHash<int, QPixmap>::iterator it) {
+            return qAbs(it.key() - m_currentFrame) > PrefetchFrames;
+        });
+        for (int frame = m_currentFrame - PrefetchFrames; frame <= m_currentFrame + PrefetchFrames; ++frame) {
+            composeFrame(frame);
+        }
+        updateFrameItem();
+    }
+
+    // requests are taken from the back, so all previews
+    // are decoded before the full quality pages
+    std::move(requestedPreviews.begin(), requestedPreviews.end(), std::back_inserter(requestedImages));
+    m_manga->addRequests(std::move(requestedImages));
 }
 
 void View::addRequest(int number)
@@ -358,14 +707,29 @@ void View::delRequest(int number)
 
 void View::onImageReady(const QImage &image, int number)
 {
+    STALL_SCOPE("View::onImageReady");
     if (number < 0 || number >= m_pages.size()) {
         return;
     }
     m_pages.at(number)->setImage(image);
+    if (auto it = m_visibleRequestTimes.find(number); it != m_visibleRequestTimes.end()) {
+        m_visibleLatency.add(m_scrollClock.elapsed() - it.value());
+        m_visibleRequestTimes.erase(it);
+    }
+    if (isPaged() && number < m_pageFrames.size()) {
+        const int frame = m_pageFrames.at(number);
+        if (qAbs(frame - m_currentFrame) <= PrefetchFrames) {
+            composeFrame(frame);
+            if (frame == m_currentFrame) {
+                updateFrameItem();
+            }
+        }
+    }
     if (m_startPage > 0) {
         goToPage(m_startPage);
         m_startPage = 0;
     }
+    Q_EMIT imageShown(number);
 }
 
 void View::onImageResized(const QImage &image, int number)
@@ -376,6 +740,22 @@ void View::onImageResized(const QImage &image, int number)
     m_pages.at(number)->redraw(image);
 }
 
+void View::onTileReady(const QImage &image, int number, int tile)
+{
+    if (number < 0 || number >= m_pages.size()) {
+        return;
+    }
+    m_pages.at(number)->setTile(tile, image);
+}
+
+void View::onPreviewReady(const QImage &image, int number)
+{
+    if (number < 0 || number >= m_pages.size()) {
+        return;
+    }
+    m_pages.at(number)->setPreview(image);
+}
+
 void View::onScrollBarRangeChanged(int x, int y)
 {
     Q_UNUSED(x)
@@ -385,6 +765,11 @@ void View::onScrollBarRangeChanged(int x, int y)
         return;
     }
 
+    if (isPaged()) {
+        showFrame(m_currentFrame);
+        return;
+    }
+
     if (m_firstVisible >= 0)
     {
         auto page = m_pages.at(m_firstVisible);
@@ -404,6 +789,8 @@ void View::refreshPages()
 
     // clear requested pages so they are resized too
     m_requestedPages.clear();
+    applyMangaSettings();
+    setVerticalScrollBarPolicy(isPaged() ? Qt::ScrollBarAlwaysOff : Qt::ScrollBarAsNeeded);
     if (MangaReaderSettings::useCustomBackgroundColor()) {
         setBackgroundBrush(MangaReaderSettings::backgroundColor());
     } else {
@@ -439,6 +826,20 @@ void View::resizeEvent(QResizeEvent *e)
     QGraphicsView::resizeEvent(e);
 }
 
+void View::paintEvent(QPaintEvent *event)
+{
+    QGraphicsView::paintEvent(event);
+    if (m_scrollAnimation->state() != QAbstractAnimation::Running) {
+        return;
+    }
+    // time between the frames painted while smooth scrolling
+    const qint64 now = m_scrollClock.elapsed();
+    if (m_lastFrameTime >= 0) {
+        m_frameTimes.add(now - m_lastFrameTime);
+    }
+    m_lastFrameTime = now;
+}
+
 void View::mouseDoubleClickEvent(QMouseEvent *event)
 {
     Q_UNUSED(event)
@@ -457,12 +858,11 @@ void View::mouseReleaseEvent(QMouseEvent *event)
     }
 
     QPointF position = mapFromGlobal(event->globalPosition());
-    Page *page;
-    if (QGraphicsItem *item = itemAt(position.toPoint())) {
-        page = qgraphicsitem_cast<Page *>(item);
+    if (Page *page = pageAt(position.toPoint())) {
         togglePageZoom(page);
     }
     calculatePageSizes();
+    setPagesVisibility();
 }
 
 void View::mouseMoveEvent(QMouseEvent *event)
@@ -484,6 +884,20 @@ void View::wheelEvent(QWheelEvent *event)
             zoomOut();
         }
         event->accept();
+    } else if (isPaged()) {
+        const int delta = event->angleDelta().y();
+        // touchpads and high resolution wheels send many small deltas,
+        // a frame is turned for each notch worth of them
+        if (delta != 0 && (delta < 0) != (m_pagedWheelDelta < 0)) {
+            m_pagedWheelDelta = 0;
+        }
+        m_pagedWheelDelta += delta;
+        const int steps = m_pagedWheelDelta / QWheelEvent::DefaultDeltasPerStep;
+        if (steps != 0) {
+            m_pagedWheelDelta -= steps * QWheelEvent::DefaultDeltasPerStep;
+            showFrame(m_currentFrame - steps);
+        }
+        event->accept();
     } else {
         if (!MangaReaderSettings::smoothScrolling()) {
             QGraphicsView::wheelEvent(event);
@@ -522,9 +936,7 @@ void View::wheelEvent(QWheelEvent *event)
 void View::contextMenuEvent(QContextMenuEvent *event)
 {
     QPoint position = mapFromGlobal(event->globalPos());
-    Page *page;
-    if (QGraphicsItem *item = itemAt(position)) {
-        page = qgraphicsitem_cast<Page *>(item);
+    if (Page *page = pageAt(position)) {
         auto menu = new QMenu();
         menu->addSection(i18n("Page %1", page->number() + 1));
 
@@ -537,6 +949,7 @@ void View::contextMenuEvent(QContextMenuEvent *event)
         menu->addAction(zoomActionIcon, zoomActionText, this, [this, page]() {
             togglePageZoom(page);
             calculatePageSizes();
+            setPagesVisibility();
         });
 
         menu->addAction(QIcon::fromTheme(u"folder-bookmark"_s), i18n("Set Bookmark"), this, [this, page] {
@@ -546,8 +959,26 @@ void View::contextMenuEvent(QContextMenuEvent *event)
             Q_EMIT addBookmark(page->number(), recursive);
         });
 
-        menu->addAction(QIcon::fromTheme(u"selection-make-bitmap-copy"_s), i18n("Copy Image"), this, [page] {
-            QApplication::clipboard()->setImage(page->image());
+        menu->addAction(QIcon::fromTheme(u"selection-make-bitmap-copy"_s), i18n("Copy Image"), this, [this, page] {
+            // in lean page memory mode pages don't keep their image
+            QImage image = page->image();
+            if (image.isNull()) {
+                image = m_manga->cachedImage(page->number());
+            }
+            if (!image.isNull()) {
+                QApplication::clipboard()->setImage(image);
+                return;
+            }
+            // evicted, decoded again at its full size rather than copying the scaled pixmap
+            const QList<Image> images = m_manga->images();
+            if (page->number() >= images.size()) {
+                return;
+            }
+            m_manga->requestPage(page->number(), images.at(page->number()).size).then(this, [](QFuture<PageImage> future) {
+                if (future.resultCount() > 0) {
+                    QApplication::clipboard()->setImage(future.takeResult().image);
+                }
+            });
         });
         menu->popup(event->globalPos());
     }
@@ -568,6 +999,11 @@ void View::setLoadFromMemory(bool newLoadFromMemory)
     m_loadFromMemory = newLoadFromMemory;
 }
 
+qreal View::decodePixelRatio() const
+{
+    return qMin(devicePixelRatioF(), MangaReaderSettings::maxDecodePixelRatio());
+}
+
 bool View::event(QEvent *event)
 {
     switch (event->type()) {
@@ -578,6 +1014,10 @@ bool View::event(QEvent *event)
             setBackgroundBrush(QPalette().base());
         }
         break;
+    case QEvent::DevicePixelRatioChange:
+        // moved to a screen with a different scale factor, decode at its resolution
+        refreshPages();
+        break;
     default:
         break;
 
@@ -585,11 +1025,69 @@ bool View::event(QEvent *event)
     return QGraphicsView::event(event);
 }
 
+void View::setHudVisible(bool visible)
+{
+    m_hud->setVisible(visible);
+    if (!visible) {
+        m_hudTimer->stop();
+        return;
+    }
+    m_hudSampleTime = m_scrollClock.elapsed();
+    m_hudStatistics = m_manga ? m_manga->statistics() : Manga::Statistics{};
+    updateHud();
+    m_hudTimer->start();
+}
+
+void View::updateHud()
+{
+    const qint64 now = m_scrollClock.elapsed();
+    const Manga::Statistics statistics = m_manga ? m_manga->statistics() : Manga::Statistics{};
+    const qint64 elapsed = qMax<qint64>(now - m_hudSampleTime, 1);
+    const qreal utilization = qBound(0.0, 100.0 * (statistics.busyTime - m_hudStatistics.busyTime) / elapsed, 100.0);
+    m_hudStatistics = statistics;
+    m_hudSampleTime = now;
+
+    const quint64 hits = statistics.pageCacheHits + statistics.compressedCacheHits + statistics.diskCacheHits;
+    const quint64 lookups = hits + statistics.cacheMisses;
+    const qreal hitRate = lookups > 0 ? 100.0 * hits / lookups : 0.0;
+
+    qint64 pageMemory{0};
+    for (const Page *page : std::as_const(m_pages)) {
+        pageMemory += page->memoryFootprint();
+    }
+    for (const QPixmap &frame : std::as_const(m_composedFrames)) {
+        pageMemory += static_cast<qint64>(frame.width()) * frame.height() * frame.depth() / 8;
+    }
+
+    const QStringList lines{
+        u"queue       %1 pending, %2"_s.arg(statistics.pendingRequests).arg(statistics.executing ? u"decoding"_s : u"idle"_s),
+        u"worker      %1% busy"_s.arg(utilization, 0, 'f', 0),
+        u"cache       %1% hits (%2 page, %3 compressed, %4 disk), %5 misses"_s.arg(hitRate, 0, 'f', 1)
+            .arg(statistics.pageCacheHits)
+            .arg(statistics.compressedCacheHits)
+            .arg(statistics.diskCacheHits)
+            .arg(statistics.cacheMisses),
+        u"latency     p50 %1 ms, p95 %2 ms (%3 visible pages)"_s.arg(m_visibleLatency.percentile(50), 0, 'f', 0)
+            .arg(m_visibleLatency.percentile(95), 0, 'f', 0)
+            .arg(m_visibleLatency.count()),
+        u"memory      %1 MiB in page images and pixmaps"_s.arg(pageMemory / (1024.0 * 1024.0), 0, 'f', 1),
+        u"frame time  mean %1 ms, max %2 ms"_s.arg(m_frameTimes.mean(), 0, 'f', 1).arg(m_frameTimes.max(), 0, 'f', 1),
+    };
+    m_hud->setText(lines.join(u'\n'));
+    m_hud->adjustSize();
+    m_hud->move(viewport()->geometry().topLeft() + QPoint(8, 8));
+    m_hud->raise();
+}
+
 void View::goToPage(int number)
 {
     if (m_pages.isEmpty()) {
         return;
     }
+    if (isPaged() && number < m_pageFrames.size()) {
+        showFrame(m_pageFrames.at(number));
+        return;
+    }
     verticalScrollBar()->setValue(m_pages.at(number)->pos().y());
 }
 
@@ -7,15 +7,21 @@
 #ifndef VIEW_H
 #define VIEW_H
 
+#include <QElapsedTimer>
 #include <QGraphicsView>
 #include <QObject>
+#include <QPixmap>
 #include <KXMLGUIClient>
 
 #include "image.h"
+#include "latencystats.h"
 #include "manga.h"
+#include "prefetchwindow.h"
 
 class Page;
+class QGraphicsPixmapItem;
 class QGraphicsScene;
+class QLabel;
 class QPropertyAnimation;
 class MainWindow;
 
@@ -35,11 +41,17 @@ public:
     void setFiles(const QList<Image> &images);
 
     void setLoadFromMemory(bool newLoadFromMemory);
+    /**
+     * Device pixels per logical pixel pages are decoded at,
+     * the screen's scale factor unless capped in the settings
+     */
+    qreal decodePixelRatio() const;
 
     bool event(QEvent *event) override;
 
 Q_SIGNALS:
     void imagesLoaded(int number);
+    void imageShown(int number);
     void requestImage(int number, const QString &name);
     void currentImageChanged(int number);
     void doubleClicked();
@@ -51,6 +63,8 @@ Q_SIGNALS:
 public Q_SLOTS:
     void onImageReady(const QImage &image, int number);
     void onImageResized(const QImage &image, int number);
+    void onTileReady(const QImage &image, int number, int tile);
+    void onPreviewReady(const QImage &image, int number);
     void onScrollBarRangeChanged(int x, int y);
     void refreshPages();
     void zoomIn();
@@ -60,12 +74,22 @@ public Q_SLOTS:
 
 private:
     void setupActions();
+    void applyMangaSettings();
     void createPages();
     void calculatePageSizes();
     void setPagesVisibility();
+    bool isPaged() const;
+    void calculatePagedLayout();
+    void showFrame(int frame);
+    void composeFrame(int frame);
+    void updateFrameItem();
+    Page *pageAt(const QPoint &position) const;
+    void setHudVisible(bool visible);
+    void updateHud();
     void addRequest(int number);
     void delRequest(int number);
     void resizeEvent(QResizeEvent *e) override;
+    void paintEvent(QPaintEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
@@ -90,6 +114,30 @@ private:
     bool             m_loadFromMemory {false};
     QPropertyAnimation *m_scrollAnimation{nullptr};
     int              m_targetScrollValue{0};
+    PrefetchWindow   m_prefetchWindow;
+    QElapsedTimer    m_scrollClock;
+    // paged mode, each frame is the page or pages shown on one screen
+    QList<QList<int>> m_frames;
+    QList<int>       m_pageFrames;
+    int              m_currentFrame{0};
+    // wheel deltas not yet turned into a frame change
+    int              m_pagedWheelDelta{0};
+    // pages covered by the composited frame
+    QList<int>       m_hiddenPages;
+    // frames near the current one, already composited
+    QHash<int, QPixmap> m_composedFrames;
+    QGraphicsPixmapItem *m_frameItem{nullptr};
+    // performance overlay
+    QLabel          *m_hud{nullptr};
+    QTimer          *m_hudTimer{nullptr};
+    // previous sample, to turn the manga's counters into rates
+    Manga::Statistics m_hudStatistics;
+    qint64           m_hudSampleTime{0};
+    // when the visible pages still missing their image were first requested
+    QHash<int, qint64> m_visibleRequestTimes;
+    LatencyStats     m_visibleLatency{200};
+    LatencyStats     m_frameTimes{120};
+    qint64           m_lastFrameTime{-1};
 };
 
 #endif // VIEW_H